@@ -1,21 +1,50 @@
 #version 460 core
+//with PACKED_VERTEX positions are in [0, 1] of the mesh AABB, which the instance transform maps back,
+//and normals are octahedral encoded
 layout (location = 0) in vec3 vecPos;
+#ifdef PACKED_VERTEX
+layout (location = 1) in vec2 vecOctNorm;
+#else
 layout (location = 1) in vec3 vecNorm;
+#endif
+//per instance, orientation quaternion as x, y, z, w
+layout (location = 2) in vec4 instRotation;
+layout (location = 3) in vec3 instPosition;
+layout (location = 4) in vec3 instScale;
+layout (location = 5) in vec3 instColor;
 
 layout (location = 0) out vec3 fragColor;
 layout (location = 1) out vec3 fragNorm;
 layout (location = 2) out vec3 position;
 
-layout (location = 0) uniform mat4 mWorld;
-layout (location = 1) uniform mat4 mProj;
-layout (location = 2) uniform mat4 mView;
-layout (location = 3) uniform vec3 scale;
-layout (location = 4) uniform vec3 color;
+layout (std140, binding = 0) uniform Camera
+{
+    mat4 mProj;
+    mat4 mView;
+};
+
+vec3 rotate(vec4 q, vec3 v)
+{
+    return v + 2.0 * cross(q.xyz, cross(q.xyz, v) + q.w * v);
+}
+
+vec3 octDecode(vec2 e)
+{
+    vec3 n = vec3(e, 1.0 - abs(e.x) - abs(e.y));
+    float fold = max(-n.z, 0.0);
+    n.x += n.x >= 0.0 ? -fold : fold;
+    n.y += n.y >= 0.0 ? -fold : fold;
+    return normalize(n);
+}
 
 void main()
 {
-    gl_Position = mProj * mView * mWorld * vec4(scale * vecPos, 1.0);
-    fragColor = color;
-    fragNorm = vecNorm;
-    position = vecPos;
+#ifdef PACKED_VERTEX
+    vec3 vecNorm = octDecode(vecOctNorm);
+#endif
+    vec3 world = instPosition + rotate(instRotation, instScale * vecPos);
+    gl_Position = mProj * mView * vec4(world, 1.0);
+    fragColor = instColor;
+    fragNorm = rotate(instRotation, vecNorm);
+    position = world;
 }
\ No newline at end of file
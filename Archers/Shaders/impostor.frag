@@ -0,0 +1,41 @@
+#version 460 core
+layout (location = 0) in vec3 fragColor;
+layout (location = 1) in vec3 viewPos;
+layout (location = 2) flat in vec3 viewCenter;
+layout (location = 3) flat in float radius;
+
+out vec4 outColor;
+
+layout (std140, binding = 0) uniform Camera
+{
+    mat4 mProj;
+    mat4 mView;
+};
+
+void main()
+{
+    //view rays are parallel for an orthographic camera and start at the eye for a perspective one
+    bool ortho = mProj[3][3] == 1.0;
+    vec3 origin = ortho ? vec3(viewPos.xy, 0.0) : vec3(0.0);
+    vec3 dir = ortho ? vec3(0.0, 0.0, -1.0) : normalize(viewPos);
+
+    vec3 oc = origin - viewCenter;
+    float b = dot(dir, oc);
+    float h = b * b - (dot(oc, oc) - radius * radius);
+    if (h < 0.0)
+        discard;
+
+    vec3 hit = origin + (-b - sqrt(h)) * dir;
+    vec4 clip = mProj * vec4(hit, 1.0);
+    gl_FragDepth = clip.z / clip.w * 0.5 + 0.5;
+
+    //lit in world space like default.frag, the view matrix is a rotation and a translation
+    mat3 toWorld = transpose(mat3(mView));
+    vec3 fragNorm = toWorld * (hit - viewCenter);
+    vec3 position = toWorld * (hit - mView[3].xyz);
+
+    const vec3 lightPos = vec3(25, 50, 0);
+
+    float diffuse =  max( 0.65, dot( normalize(fragNorm),  normalize(lightPos - position) ) );
+    outColor = vec4(fragColor * diffuse, 1.0);
+}
\ No newline at end of file
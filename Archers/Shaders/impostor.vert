@@ -0,0 +1,36 @@
+#version 460 core
+//a camera facing quad per sphere, the fragment shader traces the sphere inside it
+layout (location = 0) in vec3 vecPos;
+layout (location = 3) in vec3 instPosition;
+//x is the sphere radius
+layout (location = 4) in vec3 instScale;
+layout (location = 5) in vec3 instColor;
+
+layout (location = 0) out vec3 fragColor;
+layout (location = 1) out vec3 viewPos;
+layout (location = 2) flat out vec3 viewCenter;
+layout (location = 3) flat out float radius;
+
+layout (std140, binding = 0) uniform Camera
+{
+    mat4 mProj;
+    mat4 mView;
+};
+
+void main()
+{
+    radius = instScale.x;
+    viewCenter = (mView * vec4(instPosition, 1.0)).xyz;
+
+    //under perspective the silhouette is wider than the sphere, seen from distance d by d / sqrt(d^2 - r^2)
+    float grow = 1.0;
+    if (mProj[3][3] != 1.0)
+    {
+        float d = length(viewCenter);
+        grow = d / sqrt(max(d * d - radius * radius, 1e-4));
+    }
+
+    viewPos = viewCenter + vec3(vecPos.xy * radius * grow, 0.0);
+    gl_Position = mProj * vec4(viewPos, 1.0);
+    fragColor = instColor;
+}
\ No newline at end of file
@@ -0,0 +1,102 @@
+#include "BattleView.h"
+#include <gtc/matrix_transform.hpp>
+
+static const glm::vec3 camera_start = glm::vec3(-80.f, 60.f, 80.f);
+static const glm::vec3 sky_color = glm::vec3(0.73f, 0.84f, 0.95f);
+static const float archer_radius = 1.7f;
+
+BattleView::BattleView()
+{
+	//the same levels as the game's archer LOD chain
+	const int segments[] = { 32, 16, 8, 4 };
+	for (int i = 0; i < 4; i++)
+	{
+		SphereLevel level;
+		level.min_pixels = i + 1 < 4 ? Geometry::SphereLodPixels(segments[i + 1], 0.5f) : 0.f;
+		Geometry::GenerateSphere(archer_radius, segments[i], segments[i], level.vertices, level.indices);
+		Geometry::CalculateNormals(level.vertices, level.indices);
+		archer_levels.push_back(level);
+	}
+
+	//arrows keep the (1, 1, 1) normals, as in the game
+	Geometry::GenerateBox(glm::vec3(-5.f, -2.f, -5.f), glm::vec3(5.f, 0.f, 5.f), tile_vertices, box_indices);
+	Geometry::CalculateNormals(tile_vertices, box_indices);
+	Geometry::GenerateBox(glm::vec3(-0.1f, -0.1f, -1.5f), glm::vec3(0.1f, 0.1f, 1.5f), arrow_vertices, box_indices);
+}
+
+void BattleView::Render(Simulation& simulation, SoftwareRasterizer& rasterizer, float angle)
+{
+	float view_scale = simulation.Settings().field_extent / SimulationSettings().field_extent;
+	glm::mat4 projection = Projection(rasterizer.Width() / static_cast<float>(rasterizer.Height()), view_scale);
+	rasterizer.Begin(projection, View(CameraPosition(angle, view_scale)), sky_color);
+
+	const glm::quat identity = glm::quat(1.f, 0.f, 0.f, 0.f);
+	tiles.clear();
+	for (glm::vec3 center : FieldTiles(field_tiles, field_tiles, tile_size))
+	{
+		tiles.push_back({ identity, center, glm::vec3(0.9f), glm::vec3(0.f, 1.f, 0.f) });
+	}
+	rasterizer.Draw(tile_vertices.data(), tile_vertices.size(), box_indices.data(), box_indices.size(), tiles.data(), tiles.size());
+
+	entt::registry& registry = simulation.Registry();
+	archers.clear();
+	for (auto entity : registry.view<Archer, Position, Orientation>())
+	{
+		glm::vec3 color = registry.get<Archer>(entity).IsRed() ? glm::vec3(1.f, 0.f, 0.f) : glm::vec3(0.f, 0.f, 1.f);
+		archers.push_back({ registry.get<Orientation>(entity).ori, registry.get<Position>(entity).coord, glm::vec3(1.f), color });
+	}
+
+	//an orthographic camera shows every archer at the same size, so one level fits all of them
+	float pixels = 2.f * archer_radius * projection[1][1] * 0.5f * rasterizer.Height();
+	const SphereLevel* level = &archer_levels.back();
+	for (const SphereLevel& candidate : archer_levels)
+	{
+		if (pixels >= candidate.min_pixels)
+		{
+			level = &candidate;
+			break;
+		}
+	}
+	rasterizer.Draw(level->vertices.data(), level->vertices.size(), level->indices.data(), level->indices.size(), archers.data(), archers.size());
+
+	arrows.clear();
+	for (auto entity : registry.view<Trajectory, Position, Orientation>())
+	{
+		arrows.push_back({ registry.get<Orientation>(entity).ori, registry.get<Position>(entity).coord, glm::vec3(1.f), glm::vec3(0.f) });
+	}
+	rasterizer.Draw(arrow_vertices.data(), arrow_vertices.size(), box_indices.data(), box_indices.size(), arrows.data(), arrows.size());
+
+	rasterizer.End();
+}
+
+glm::vec3 BattleView::CameraPosition(float angle, float view_scale)
+{
+	return glm::angleAxis(glm::radians(angle), glm::vec3(0.f, 1.f, 0.f)) * camera_start * view_scale;
+}
+
+glm::mat4 BattleView::Projection(float aspect, float view_scale)
+{
+	float half_height = 65.f * view_scale;
+	return glm::ortho(-half_height * aspect, half_height * aspect, -half_height, half_height, 0.01f, 200.f * view_scale);
+}
+
+glm::mat4 BattleView::View(glm::vec3 camera_position)
+{
+	return glm::lookAt(camera_position, glm::vec3(0.f, 0.f, 0.f), glm::vec3(0.f, 1.f, 0.f));
+}
+
+std::vector<glm::vec3> BattleView::FieldTiles(int tiles_h, int tiles_v, int size)
+{
+	std::vector<glm::vec3> centers;
+	//whole units, as the field has always been laid out
+	int start = static_cast<int>(-(tiles_h * tiles_v / 2.f) + size / 2.f);
+	for (int i = 0; i < tiles_v; i++)
+	{
+		for (int j = 0; j < tiles_h; j++)
+		{
+			centers.push_back(glm::vec3(start + i * size, 0, start + j * size));
+		}
+	}
+
+	return centers;
+}
@@ -0,0 +1,44 @@
+#pragma once
+#include "Simulation.h"
+#include "SoftwareRasterizer.h"
+
+//how the game frames a battle and what it draws there, shared by the window and the software rasterizer
+class BattleView
+{
+public:
+	//the field and the arrow as the game builds them, archers as spheres of 32, 16, 8 or 4 segments
+	BattleView();
+
+	//archers, arrows and the field at the simulation's current tick, with the camera turned by angle degrees
+	void Render(Simulation& simulation, SoftwareRasterizer& rasterizer, float angle = 0.f);
+
+	//the camera circles the center of the field, larger battles are seen from further away
+	static glm::vec3 CameraPosition(float angle, float view_scale);
+	static glm::mat4 Projection(float aspect, float view_scale);
+	static glm::mat4 View(glm::vec3 camera_position);
+	//centers of a tiles_h by tiles_v field around the origin
+	static std::vector<glm::vec3> FieldTiles(int tiles_h, int tiles_v, int tile_size);
+
+	//the game's field, 10 by 10 tiles of 10 units
+	static const int field_tiles = 10;
+	static const int tile_size = 10;
+
+private:
+	struct SphereLevel
+	{
+		//drawn at this projected diameter and above
+		float min_pixels;
+		std::vector<Vertex> vertices;
+		std::vector<uint32_t> indices;
+	};
+
+	std::vector<SphereLevel> archer_levels;
+	std::vector<Vertex> tile_vertices;
+	std::vector<Vertex> arrow_vertices;
+	std::vector<uint32_t> box_indices;
+
+	//kept between frames so their storage is reused
+	std::vector<RasterInstance> tiles;
+	std::vector<RasterInstance> archers;
+	std::vector<RasterInstance> arrows;
+};
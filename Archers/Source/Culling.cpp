@@ -0,0 +1,153 @@
+#include "Culling.h"
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#define CULL_LANES 8
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define CULL_LANES 4
+#else
+#define CULL_LANES 1
+#endif
+
+Frustum Frustum::FromMatrix(const glm::mat4& view_projection)
+{
+	//Gribb-Hartmann, rows of the matrix combined against -w <= x, y, z <= w
+	glm::vec4 row[4];
+	for (int i = 0; i < 4; i++)
+	{
+		row[i] = glm::vec4(view_projection[0][i], view_projection[1][i], view_projection[2][i], view_projection[3][i]);
+	}
+
+	Frustum frustum;
+	frustum.planes[0] = row[3] + row[0];
+	frustum.planes[1] = row[3] - row[0];
+	frustum.planes[2] = row[3] + row[1];
+	frustum.planes[3] = row[3] - row[1];
+	frustum.planes[4] = row[3] + row[2];
+	frustum.planes[5] = row[3] - row[2];
+
+	for (glm::vec4& plane : frustum.planes)
+	{
+		plane /= glm::length(glm::vec3(plane));
+	}
+
+	return frustum;
+}
+
+bool Frustum::ContainsSphere(glm::vec3 center, float radius) const
+{
+	for (const glm::vec4& plane : planes)
+	{
+		//same order of operations as the SIMD path so both agree on spheres touching a plane
+		float distance = plane.x * center.x + plane.y * center.y + plane.z * center.z + plane.w;
+		if (distance < -radius)
+			return false;
+	}
+
+	return true;
+}
+
+size_t FrustumCuller::CullScalar(const Frustum& frustum, const SphereSet& spheres, std::vector<uint32_t>& out_visible)
+{
+	size_t count = spheres.Size();
+	out_visible.clear();
+
+	for (size_t i = 0; i < count; i++)
+	{
+		if (frustum.ContainsSphere(glm::vec3(spheres.x[i], spheres.y[i], spheres.z[i]), spheres.radius[i]))
+			out_visible.push_back(static_cast<uint32_t>(i));
+	}
+
+	return out_visible.size();
+}
+
+size_t FrustumCuller::Cull(const Frustum& frustum, const SphereSet& spheres, std::vector<uint32_t>& out_visible)
+{
+	size_t count = spheres.Size();
+	out_visible.resize(count);
+	uint32_t* visible = out_visible.data();
+	size_t visible_count = 0;
+	size_t i = 0;
+
+#if CULL_LANES == 8
+	__m256 plane_x[6], plane_y[6], plane_z[6], plane_w[6];
+	for (int p = 0; p < 6; p++)
+	{
+		plane_x[p] = _mm256_set1_ps(frustum.planes[p].x);
+		plane_y[p] = _mm256_set1_ps(frustum.planes[p].y);
+		plane_z[p] = _mm256_set1_ps(frustum.planes[p].z);
+		plane_w[p] = _mm256_set1_ps(frustum.planes[p].w);
+	}
+
+	for (; i + 8 <= count; i += 8)
+	{
+		__m256 x = _mm256_loadu_ps(&spheres.x[i]);
+		__m256 y = _mm256_loadu_ps(&spheres.y[i]);
+		__m256 z = _mm256_loadu_ps(&spheres.z[i]);
+		__m256 neg_radius = _mm256_sub_ps(_mm256_setzero_ps(), _mm256_loadu_ps(&spheres.radius[i]));
+		__m256 culled = _mm256_setzero_ps();
+
+		for (int p = 0; p < 6; p++)
+		{
+			__m256 distance = _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(plane_x[p], x), _mm256_mul_ps(plane_y[p], y)), _mm256_mul_ps(plane_z[p], z)), plane_w[p]);
+			culled = _mm256_or_ps(culled, _mm256_cmp_ps(distance, neg_radius, _CMP_LT_OQ));
+		}
+
+		//every lane is written, only the visible ones advance the output
+		int inside = ~_mm256_movemask_ps(culled) & 0xFF;
+		for (int lane = 0; lane < 8; lane++)
+		{
+			visible[visible_count] = static_cast<uint32_t>(i + lane);
+			visible_count += (inside >> lane) & 1;
+		}
+	}
+#elif CULL_LANES == 4
+	__m128 plane_x[6], plane_y[6], plane_z[6], plane_w[6];
+	for (int p = 0; p < 6; p++)
+	{
+		plane_x[p] = _mm_set1_ps(frustum.planes[p].x);
+		plane_y[p] = _mm_set1_ps(frustum.planes[p].y);
+		plane_z[p] = _mm_set1_ps(frustum.planes[p].z);
+		plane_w[p] = _mm_set1_ps(frustum.planes[p].w);
+	}
+
+	for (; i + 4 <= count; i += 4)
+	{
+		__m128 x = _mm_loadu_ps(&spheres.x[i]);
+		__m128 y = _mm_loadu_ps(&spheres.y[i]);
+		__m128 z = _mm_loadu_ps(&spheres.z[i]);
+		__m128 neg_radius = _mm_sub_ps(_mm_setzero_ps(), _mm_loadu_ps(&spheres.radius[i]));
+		__m128 culled = _mm_setzero_ps();
+
+		for (int p = 0; p < 6; p++)
+		{
+			__m128 distance = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(plane_x[p], x), _mm_mul_ps(plane_y[p], y)), _mm_mul_ps(plane_z[p], z)), plane_w[p]);
+			culled = _mm_or_ps(culled, _mm_cmplt_ps(distance, neg_radius));
+		}
+
+		//every lane is written, only the visible ones advance the output
+		int inside = ~_mm_movemask_ps(culled) & 0xF;
+		for (int lane = 0; lane < 4; lane++)
+		{
+			visible[visible_count] = static_cast<uint32_t>(i + lane);
+			visible_count += (inside >> lane) & 1;
+		}
+	}
+#endif
+
+	//whatever doesn't fill a whole register
+	for (; i < count; i++)
+	{
+		visible[visible_count] = static_cast<uint32_t>(i);
+		visible_count += frustum.ContainsSphere(glm::vec3(spheres.x[i], spheres.y[i], spheres.z[i]), spheres.radius[i]) ? 1 : 0;
+	}
+
+	out_visible.resize(visible_count);
+	return visible_count;
+}
+
+int FrustumCuller::Lanes()
+{
+	return CULL_LANES;
+}
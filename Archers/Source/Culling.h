@@ -0,0 +1,67 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <glm.hpp>
+
+//view volume as six inward facing planes, normalized so that plane distances are in world units
+struct Frustum
+{
+	glm::vec4 planes[6];
+
+	//planes of a GL clip space volume, works for perspective and orthographic projections
+	static Frustum FromMatrix(const glm::mat4& view_projection);
+	bool ContainsSphere(glm::vec3 center, float radius) const;
+};
+
+//bounding spheres to cull, one array per component so the SIMD path loads 4 or 8 spheres at once
+struct SphereSet
+{
+	std::vector<float> x;
+	std::vector<float> y;
+	std::vector<float> z;
+	std::vector<float> radius;
+
+	void Clear()
+	{
+		x.clear();
+		y.clear();
+		z.clear();
+		radius.clear();
+	}
+
+	void Add(glm::vec3 center, float sphere_radius)
+	{
+		x.push_back(center.x);
+		y.push_back(center.y);
+		z.push_back(center.z);
+		radius.push_back(sphere_radius);
+	}
+
+	size_t Size() const
+	{
+		return x.size();
+	}
+};
+
+struct CullStats
+{
+	size_t tested = 0;
+	size_t visible = 0;
+
+	size_t Culled() const
+	{
+		return tested - visible;
+	}
+};
+
+class FrustumCuller
+{
+public:
+	//indices of the spheres at least partly inside the frustum in increasing order, returns their count
+	static size_t Cull(const Frustum& frustum, const SphereSet& spheres, std::vector<uint32_t>& out_visible);
+	//one sphere at a time, the reference the SIMD path has to match
+	static size_t CullScalar(const Frustum& frustum, const SphereSet& spheres, std::vector<uint32_t>& out_visible);
+	//spheres tested at once, 8 when built with AVX, 4 with SSE2, 1 otherwise
+	static int Lanes();
+};
@@ -1,7 +1,11 @@
 #pragma once
 #include <math.h>
 #include <entt.hpp>
-#include "GLAPI.h"
+#include <glm.hpp>
+#include <gtc/quaternion.hpp>
+
+//components don't depend on the renderer, simulation builds without GL
+struct Mesh;
 
 struct MeshComponent
 {
@@ -33,6 +37,11 @@ private:
 	glm::vec3 clr;
 };
 
+//the entity never moves, its mesh is merged into a static batch at setup and not drawn on its own
+struct StaticMesh
+{
+};
+
 struct Archer
 {
 	Archer(bool is_red = true)
@@ -46,14 +55,14 @@ struct Archer
 		return red;
 	}
 
-	bool CanShoot()
+	bool CanShoot(double now)
 	{
-		return (glfwGetTime() - last_shot) > reload_time;
+		return (now - last_shot) > reload_time;
 	}
 
-	void Reload()
+	void Reload(double now)
 	{
-		last_shot = glfwGetTime();
+		last_shot = now;
 	}
 
 private:
@@ -92,6 +101,7 @@ struct Position
 	};
 };
 
+//units per second
 struct Velocity
 {
 	glm::vec3 vel;
@@ -142,6 +152,13 @@ struct Orientation
 	};
 };
 
+//transform at the start of the current tick, rendering blends from it towards Position/Orientation
+struct PrevTransform
+{
+	glm::vec3 pos;
+	glm::quat ori;
+};
+
 struct Health
 {
 	Health(int starting_health = 100)
@@ -165,7 +182,7 @@ private:
 
 struct Trajectory
 {
-	Trajectory(glm::vec3 s, glm::vec3 t, float speed)
+	Trajectory(glm::vec3 s, glm::vec3 t, float speed, double now, bool high_arc, entt::entity shooter = entt::null)
 	{
 		const float gravity = 9.8f;
 		glm::vec3 diff = t - s;
@@ -179,35 +196,57 @@ struct Trajectory
 
 		if (root >= 0)
 		{
-			float sign = std::rand() % 2 == 0 ? 1.f : -1.f;
+			float sign = high_arc ? 1.f : -1.f;
 			root = glm::sqrt(root);
-			float ang = std::atan2f(speed_sq + root * sign, gravity * x);
+			float ang = std::atan2(speed_sq + root * sign, gravity * x);
 			vx = speed * glm::cos(ang) * xz_pl.x;
 			vz = speed * glm::cos(ang) * xz_pl.z;
 			vy = speed * glm::sin(ang);
 		}
 
-		s_time = glfwGetTime();
+		s_time = now;
+		l_time = s_time;
 		s_pos = s;
+		owner = shooter;
 	}
 
-	void UpdatePosition(Position& curPos, Orientation& curOri)
+	void UpdatePosition(Position& curPos, Orientation& curOri, double now)
 	{
-		double c_time = glfwGetTime();
-		double time = c_time - s_time;
-		glm::vec3 newPos;
-
-		newPos.x = s_pos.x + (vx * time);
-		newPos.z = s_pos.z + (vz * time);
-		newPos.y = s_pos.y + ((vy * time) - (0.5f * 9.8f * glm::pow(time, 2)));
+		l_time = now;
+		glm::vec3 newPos = PositionAt(Elapsed());
 
 		curOri = glm::quatLookAt(glm::normalize(newPos - curPos.coord), glm::vec3(0.f, 1.f, 0.f));
 		curPos = newPos;
 	}
 
+	//closed-form position, time is counted from the shot
+	glm::vec3 PositionAt(double time) const
+	{
+		glm::vec3 pos;
+
+		pos.x = s_pos.x + (vx * time);
+		pos.z = s_pos.z + (vz * time);
+		pos.y = s_pos.y + ((vy * time) - (0.5f * 9.8f * glm::pow(time, 2)));
+
+		return pos;
+	}
+
+	//time from the shot to the last position update
+	double Elapsed() const
+	{
+		return l_time - s_time;
+	}
+
+	entt::entity Owner() const
+	{
+		return owner;
+	}
+
 private:
 	glm::vec3 s_pos;
 	double s_time;
+	double l_time;
+	entt::entity owner;
 	float vx;
 	float vy;
 	float vz;
@@ -3,6 +3,7 @@
 #include <vector>
 #include <string>
 #include <fstream>
+#include <iterator>
 
 class FileManager
 {
@@ -24,4 +25,49 @@ public:
 
 		return buffer;
 	}
+
+	//whole file as a string, empty when it can't be opened
+	static std::string ReadTextFile(const std::string& filename)
+	{
+		std::ifstream file(filename);
+
+		if (!file.is_open())
+		{
+			return {};
+		}
+
+		return std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+	}
+
+	//contents byte for byte, no line ending conversion
+	static std::vector<char> ReadBinaryFile(const std::string& filename)
+	{
+		std::ifstream file(filename, std::ios::ate | std::ios::binary);
+
+		if (!file.is_open())
+		{
+			return {};
+		}
+
+		std::size_t fileSize = (std::size_t)file.tellg();
+		std::vector<char> buffer(fileSize);
+		file.seekg(0);
+		file.read(buffer.data(), fileSize);
+		file.close();
+
+		return buffer;
+	}
+
+	static bool WriteBinaryFile(const std::string& filename, const std::vector<char>& data)
+	{
+		std::ofstream file(filename, std::ios::binary | std::ios::trunc);
+
+		if (!file.is_open())
+		{
+			return false;
+		}
+
+		file.write(data.data(), data.size());
+		return file.good();
+	}
 };
\ No newline at end of file
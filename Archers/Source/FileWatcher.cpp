@@ -0,0 +1,95 @@
+#include "FileWatcher.h"
+
+#if defined(__linux__)
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+static std::filesystem::file_time_type WriteTime(const std::filesystem::path& path)
+{
+	std::error_code error;
+	std::filesystem::file_time_type time = std::filesystem::last_write_time(path, error);
+	return error ? std::filesystem::file_time_type::min() : time;
+}
+
+FileWatcher::FileWatcher()
+{
+#if defined(__linux__)
+	inotify = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+#endif
+}
+
+FileWatcher::~FileWatcher()
+{
+#if defined(__linux__)
+	if (inotify >= 0)
+		close(inotify);
+#endif
+}
+
+void FileWatcher::Watch(const std::string& path)
+{
+	WatchedFile file;
+	file.path = std::filesystem::absolute(path).lexically_normal();
+	file.write_time = WriteTime(file.path);
+
+#if defined(__linux__)
+	if (inotify >= 0)
+	{
+		//a finished write or a file moved over the old one, watching a directory twice returns the same descriptor
+		uint32_t mask = IN_CLOSE_WRITE | IN_MOVED_TO;
+		file.watch = inotify_add_watch(inotify, file.path.parent_path().c_str(), mask);
+	}
+#endif
+
+	files.push_back(file);
+}
+
+bool FileWatcher::Poll()
+{
+	bool changed = false;
+
+#if defined(__linux__)
+	if (inotify >= 0)
+	{
+		alignas(inotify_event) char events[4096];
+		ssize_t length;
+		while ((length = read(inotify, events, sizeof(events))) > 0)
+		{
+			for (char* pointer = events; pointer < events + length;)
+			{
+				const inotify_event* event = reinterpret_cast<const inotify_event*>(pointer);
+				pointer += sizeof(inotify_event) + event->len;
+
+				for (const WatchedFile& file : files)
+				{
+					if (event->len > 0 && event->wd == file.watch && file.path.filename() == event->name)
+						changed = true;
+				}
+			}
+		}
+
+		//files whose directory couldn't be watched are still compared by time below
+		bool all_watched = true;
+		for (const WatchedFile& file : files)
+		{
+			all_watched = all_watched && file.watch >= 0;
+		}
+
+		if (all_watched)
+			return changed;
+	}
+#endif
+
+	for (WatchedFile& file : files)
+	{
+		std::filesystem::file_time_type time = WriteTime(file.path);
+		if (time != file.write_time)
+		{
+			file.write_time = time;
+			changed = true;
+		}
+	}
+
+	return changed;
+}
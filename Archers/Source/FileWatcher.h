@@ -0,0 +1,31 @@
+#pragma once
+#include <filesystem>
+#include <string>
+#include <vector>
+
+//reports changes of a set of files without blocking, inotify on Linux and modification times elsewhere
+class FileWatcher
+{
+public:
+	FileWatcher();
+	~FileWatcher();
+
+	FileWatcher(const FileWatcher&) = delete;
+	FileWatcher& operator=(const FileWatcher&) = delete;
+
+	void Watch(const std::string& path);
+	//true when any watched file was written or replaced since the last Poll
+	bool Poll();
+
+private:
+	struct WatchedFile
+	{
+		std::filesystem::path path;
+		std::filesystem::file_time_type write_time;
+		//inotify watches directories, editors often save by replacing the file
+		int watch = -1;
+	};
+
+	std::vector<WatchedFile> files;
+	int inotify = -1;
+};
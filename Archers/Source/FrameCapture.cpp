@@ -0,0 +1,422 @@
+#include "FrameCapture.h"
+#include <chrono>
+#include <cstring>
+#include "Profiler.h"
+
+#ifdef _WIN32
+#define popen _popen
+#define pclose _pclose
+static const char* pipe_mode = "wb";
+#else
+#include <csignal>
+static const char* pipe_mode = "w";
+#endif
+
+//PNG and zlib checksums, the table is built once on first use
+static uint32_t Crc32(uint32_t crc, const uint8_t* data, size_t size)
+{
+	struct Table
+	{
+		uint32_t entries[256];
+
+		Table()
+		{
+			for (uint32_t n = 0; n < 256; n++)
+			{
+				uint32_t c = n;
+				for (int k = 0; k < 8; k++)
+				{
+					c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+				}
+				entries[n] = c;
+			}
+		}
+	};
+	static const Table table;
+
+	crc = ~crc;
+	for (size_t i = 0; i < size; i++)
+	{
+		crc = table.entries[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+	}
+	return ~crc;
+}
+
+static uint32_t Adler32(const uint8_t* data, size_t size)
+{
+	uint32_t a = 1;
+	uint32_t b = 0;
+	while (size > 0)
+	{
+		//the largest run that can't overflow b before the modulo
+		size_t run = size < 5552 ? size : 5552;
+		for (size_t i = 0; i < run; i++)
+		{
+			a += data[i];
+			b += a;
+		}
+		a %= 65521;
+		b %= 65521;
+		data += run;
+		size -= run;
+	}
+	return (b << 16) | a;
+}
+
+static void PutBigEndian(uint8_t* out, uint32_t value)
+{
+	out[0] = static_cast<uint8_t>(value >> 24);
+	out[1] = static_cast<uint8_t>(value >> 16);
+	out[2] = static_cast<uint8_t>(value >> 8);
+	out[3] = static_cast<uint8_t>(value);
+}
+
+//writes data and folds it into the crc of the chunk it belongs to
+static bool WriteChunkData(FILE* out, const uint8_t* data, size_t size, uint32_t& crc)
+{
+	crc = Crc32(crc, data, size);
+	return fwrite(data, 1, size, out) == size;
+}
+
+static bool BeginChunk(FILE* out, const char* type, size_t size, uint32_t& crc)
+{
+	uint8_t length[4];
+	PutBigEndian(length, static_cast<uint32_t>(size));
+	crc = 0;
+	return fwrite(length, 1, 4, out) == 4 && WriteChunkData(out, reinterpret_cast<const uint8_t*>(type), 4, crc);
+}
+
+static bool EndChunk(FILE* out, uint32_t crc)
+{
+	uint8_t footer[4];
+	PutBigEndian(footer, crc);
+	return fwrite(footer, 1, 4, out) == 4;
+}
+
+//rows of RGB24 each led by a filter byte, stored without compression since there is no zlib to lean on. A frame is
+//about as big as the raw one, encoders that care about size should get the pipe instead
+static bool WritePng(const char* name, const std::vector<uint8_t>& rows, int width, int height)
+{
+	FILE* out = fopen(name, "wb");
+	if (out == nullptr)
+		return false;
+
+	const uint8_t signature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+	bool written = fwrite(signature, 1, 8, out) == 8;
+
+	//8 bit RGB, deflate, no filtering across rows, not interlaced
+	uint8_t header[13] = { 0, 0, 0, 0, 0, 0, 0, 0, 8, 2, 0, 0, 0 };
+	PutBigEndian(header, static_cast<uint32_t>(width));
+	PutBigEndian(header + 4, static_cast<uint32_t>(height));
+	uint32_t crc = 0;
+	written = written && BeginChunk(out, "IHDR", sizeof(header), crc) && WriteChunkData(out, header, sizeof(header), crc) &&
+		EndChunk(out, crc);
+
+	//a zlib stream of stored blocks of at most 65535 bytes, written straight from the rows
+	const size_t max_block = 65535;
+	size_t blocks = (rows.size() + max_block - 1) / max_block;
+	const uint8_t zlib_header[2] = { 0x78, 0x01 };
+	written = written && BeginChunk(out, "IDAT", 2 + blocks * 5 + rows.size() + 4, crc) && WriteChunkData(out, zlib_header, 2, crc);
+	for (size_t offset = 0; written && offset < rows.size(); offset += max_block)
+	{
+		size_t block = rows.size() - offset < max_block ? rows.size() - offset : max_block;
+		uint8_t block_header[5] = { static_cast<uint8_t>(offset + block == rows.size() ? 1 : 0), static_cast<uint8_t>(block),
+			static_cast<uint8_t>(block >> 8), static_cast<uint8_t>(~block), static_cast<uint8_t>(~block >> 8) };
+		written = WriteChunkData(out, block_header, 5, crc) && WriteChunkData(out, rows.data() + offset, block, crc);
+	}
+	uint8_t adler[4];
+	PutBigEndian(adler, Adler32(rows.data(), rows.size()));
+	written = written && WriteChunkData(out, adler, 4, crc) && EndChunk(out, crc);
+
+	written = written && BeginChunk(out, "IEND", 0, crc) && EndChunk(out, crc);
+	return fclose(out) == 0 && written;
+}
+
+//splits a PNG path at its single %d, %Nd or %0Nd, false if it has another % or none
+static bool SplitFramePattern(const std::string& path, std::string& prefix, std::string& suffix, int& width, bool& zero_pad)
+{
+	size_t percent = path.find('%');
+	if (percent == std::string::npos)
+		return false;
+
+	size_t end = percent + 1;
+	zero_pad = end < path.size() && path[end] == '0';
+	if (zero_pad)
+		end++;
+	width = 0;
+	while (end < path.size() && path[end] >= '0' && path[end] <= '9' && width <= 32)
+	{
+		width = width * 10 + (path[end] - '0');
+		end++;
+	}
+	if (width > 32 || end >= path.size() || path[end] != 'd' || path.find('%', end) != std::string::npos)
+		return false;
+
+	prefix = path.substr(0, percent);
+	suffix = path.substr(end + 1);
+	return true;
+}
+
+FrameCapture::FrameCapture(RenderBackend& capture_backend, int slot_count) : backend(capture_backend), slots(slot_count)
+{
+}
+
+FrameCapture::~FrameCapture()
+{
+	Stop();
+}
+
+bool FrameCapture::Start(const std::string& target, int capture_width, int capture_height)
+{
+	Stop();
+
+	const std::string png = ".png";
+	if (target.empty() == false && target[0] == '|')
+	{
+#ifndef _WIN32
+		//an encoder that exits early would otherwise take the game with it on the next write
+		signal(SIGPIPE, SIG_IGN);
+#endif
+		file = popen(target.c_str() + 1, pipe_mode);
+		sink = Sink::Pipe;
+	}
+	else if (target.size() > png.size() && target.compare(target.size() - png.size(), png.size(), png) == 0)
+	{
+		std::string pattern = target;
+		if (pattern.find('%') == std::string::npos)
+		{
+			pattern.insert(pattern.size() - png.size(), "_%05d");
+		}
+		if (SplitFramePattern(pattern, path_prefix, path_suffix, number_width, zero_pad) == false)
+		{
+			printf("can't open %s to capture into\n", target.c_str());
+			return false;
+		}
+		sink = Sink::Png;
+	}
+	else
+	{
+		file = fopen(target.c_str(), "wb");
+		sink = Sink::Raw;
+	}
+
+	if (sink != Sink::Png && file == nullptr)
+	{
+		printf("can't open %s to capture into\n", target.c_str());
+		sink = Sink::None;
+		return false;
+	}
+
+	width = capture_width;
+	height = capture_height;
+	size_t frame_bytes = static_cast<size_t>(width) * height * 4;
+	for (Slot& slot : slots)
+	{
+		void* mapped = nullptr;
+		slot.buffer = backend.CreateReadbackBuffer(frame_bytes, &mapped);
+		slot.pixels = static_cast<const uint8_t*>(mapped);
+		slot.fence = nullptr;
+		slot.busy = false;
+	}
+
+	//PNG rows lead with their filter byte
+	size_t row_bytes = static_cast<size_t>(width) * 3 + (sink == Sink::Png ? 1 : 0);
+	image.assign(row_bytes * height, 0);
+	next_frame = 0;
+	stats = CaptureStats();
+	stopping = false;
+	writer = std::thread(&FrameCapture::WriterLoop, this);
+	return true;
+}
+
+void FrameCapture::Capture()
+{
+	if (sink == Sink::None)
+		return;
+
+	PROFILE_ZONE("Capture");
+	auto start = std::chrono::steady_clock::now();
+
+	//reads finish in the order they were queued, the first fence still pending ends the arrivals
+	size_t arrived = 0;
+	while (arrived < reading.size() && backend.WaitFence(slots[reading[arrived]].fence, 0))
+	{
+		arrived++;
+	}
+	HandOver(arrived);
+
+	int free_slot = -1;
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		for (size_t i = 0; i < slots.size(); i++)
+		{
+			if (slots[i].busy == false)
+			{
+				slots[i].busy = true;
+				free_slot = static_cast<int>(i);
+				break;
+			}
+		}
+	}
+
+	if (free_slot >= 0)
+	{
+		Slot& slot = slots[free_slot];
+		backend.ReadFramebuffer(slot.buffer, width, height);
+		slot.fence = backend.InsertFence();
+		slot.frame = next_frame++;
+		reading.push_back(free_slot);
+	}
+
+	double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	std::lock_guard<std::mutex> lock(mutex);
+	if (free_slot >= 0)
+	{
+		stats.captured++;
+	}
+	else
+	{
+		stats.dropped++;
+	}
+	stats.render_seconds += seconds;
+	if (seconds > stats.max_render_seconds)
+	{
+		stats.max_render_seconds = seconds;
+	}
+}
+
+void FrameCapture::Stop()
+{
+	if (sink == Sink::None)
+		return;
+
+	//the frames still on the GPU are part of the capture
+	for (int index : reading)
+	{
+		bool signaled = false;
+		while (signaled == false)
+		{
+			signaled = backend.WaitFence(slots[index].fence, 1000000);
+		}
+	}
+	HandOver(reading.size());
+
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		stopping = true;
+	}
+	wake.notify_one();
+	writer.join();
+
+	if (sink == Sink::Pipe)
+	{
+		pclose(file);
+	}
+	else if (sink == Sink::Raw)
+	{
+		fclose(file);
+	}
+	file = nullptr;
+
+	for (Slot& slot : slots)
+	{
+		backend.DeleteBuffer(slot.buffer);
+		slot = Slot();
+	}
+	sink = Sink::None;
+}
+
+CaptureStats FrameCapture::Stats()
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	return stats;
+}
+
+void FrameCapture::HandOver(size_t count)
+{
+	if (count == 0)
+		return;
+
+	for (size_t i = 0; i < count; i++)
+	{
+		Slot& slot = slots[reading[i]];
+		backend.DeleteFence(slot.fence);
+		slot.fence = nullptr;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		ready.insert(ready.end(), reading.begin(), reading.begin() + count);
+	}
+	reading.erase(reading.begin(), reading.begin() + count);
+	wake.notify_one();
+}
+
+void FrameCapture::WriterLoop()
+{
+	Profiler::SetThreadName("Capture");
+
+	std::unique_lock<std::mutex> lock(mutex);
+	while (true)
+	{
+		wake.wait(lock, [this]()
+		{
+			return stopping || ready.empty() == false;
+		});
+		//stopping only ends the loop once every frame handed over is out
+		if (ready.empty())
+			break;
+
+		int index = ready.front();
+		ready.pop_front();
+		lock.unlock();
+
+		bool written = WriteFrame(slots[index]);
+
+		lock.lock();
+		slots[index].busy = false;
+		if (written)
+		{
+			stats.written++;
+		}
+		else
+		{
+			stats.failed++;
+		}
+	}
+}
+
+bool FrameCapture::WriteFrame(const Slot& slot)
+{
+	PROFILE_ZONE("WriteFrame");
+
+	//GL rows start at the bottom, the targets want them from the top and without alpha
+	bool png = sink == Sink::Png;
+	size_t row_bytes = static_cast<size_t>(width) * 3 + (png ? 1 : 0);
+	for (int y = 0; y < height; y++)
+	{
+		const uint8_t* source = slot.pixels + static_cast<size_t>(height - 1 - y) * width * 4;
+		uint8_t* destination = image.data() + static_cast<size_t>(y) * row_bytes;
+		if (png)
+		{
+			*destination++ = 0;
+		}
+		for (int x = 0; x < width; x++)
+		{
+			destination[0] = source[0];
+			destination[1] = source[1];
+			destination[2] = source[2];
+			destination += 3;
+			source += 4;
+		}
+	}
+
+	if (png)
+	{
+		char number[64];
+		snprintf(number, sizeof(number), zero_pad ? "%0*llu" : "%*llu", number_width, static_cast<unsigned long long>(slot.frame));
+		std::string name = path_prefix + number + path_suffix;
+		return WritePng(name.c_str(), image, width, height);
+	}
+	return fwrite(image.data(), 1, image.size(), file) == image.size();
+}
@@ -0,0 +1,114 @@
+#pragma once
+#include <condition_variable>
+#include <cstdio>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "RenderBackend.h"
+
+struct CaptureStats
+{
+	//frames whose read was queued, written out and skipped because every slot was still busy
+	uint64_t captured = 0;
+	uint64_t written = 0;
+	uint64_t dropped = 0;
+	//frames the target refused, a full disk or an encoder that exited
+	uint64_t failed = 0;
+	//time Capture took on the render thread
+	double render_seconds = 0.0;
+	double max_render_seconds = 0.0;
+};
+
+//records the frames drawn into the window without stalling the render thread. Each frame is read into one of a ring
+//of pixel buffers the GPU fills in the background, once its fence is signaled a writer thread converts it and hands
+//it to the target. When the writer falls behind and no buffer is free the frame is dropped rather than waited for
+class FrameCapture
+{
+public:
+	//slots are the frames that can be between the GPU and the writer at once
+	FrameCapture(RenderBackend& capture_backend, int slot_count = 4);
+	~FrameCapture();
+
+	FrameCapture(const FrameCapture&) = delete;
+	FrameCapture& operator=(const FrameCapture&) = delete;
+
+	//target is a file every frame is appended to as raw RGB24, a path ending in .png written as one PNG per frame
+	//numbered through one %d, %5d or %05d like frames/%05d.png, or a command after a | that gets the raw frames on stdin,
+	//false when the target can't be opened or its pattern has any other % in it
+	bool Start(const std::string& target, int width, int height);
+	//queues the frame drawn so far, call after the last draw and before swapping buffers
+	void Capture();
+	//waits for the frames in flight to be written and closes the target
+	void Stop();
+
+	bool IsCapturing() const
+	{
+		return sink != Sink::None;
+	}
+
+	int Width() const
+	{
+		return width;
+	}
+
+	int Height() const
+	{
+		return height;
+	}
+
+	//safe to read while capturing, written and failed trail the writer. Kept after Stop until the next Start
+	CaptureStats Stats();
+
+private:
+	enum class Sink
+	{
+		None,
+		Raw,
+		Png,
+		Pipe
+	};
+
+	struct Slot
+	{
+		uint32_t buffer = 0;
+		const uint8_t* pixels = nullptr;
+		RenderFence fence = nullptr;
+		//number of the frame in the capture
+		uint64_t frame = 0;
+		//between the read and the end of the writer's work on it
+		bool busy = false;
+	};
+
+	//gives the first count slots of reading, whose fences are signaled, to the writer
+	void HandOver(size_t count);
+	void WriterLoop();
+	bool WriteFrame(const Slot& slot);
+
+	RenderBackend& backend;
+	std::vector<Slot> slots;
+	Sink sink = Sink::None;
+	//PNG names are the prefix, the frame number padded to number_width and the suffix
+	std::string path_prefix;
+	std::string path_suffix;
+	int number_width = 0;
+	bool zero_pad = false;
+	FILE* file = nullptr;
+	int width = 0;
+	int height = 0;
+	uint64_t next_frame = 0;
+	//slots read by the GPU in frame order, owned by the render thread
+	std::deque<int> reading;
+
+	std::thread writer;
+	std::mutex mutex;
+	std::condition_variable wake;
+	//slots whose pixels have arrived, oldest first
+	std::deque<int> ready;
+	bool stopping = false;
+	CaptureStats stats;
+
+	//rows converted by the writer
+	std::vector<uint8_t> image;
+};
@@ -1,89 +1,5 @@
 #include "GLAPI.h"
-
-Mesh::Mesh(std::vector<Vertex> vertices, std::vector<uint32_t> indices)
-{
-	verts.resize(vertices.size());
-	inds.resize(indices.size());
-	std::copy(vertices.begin(), vertices.end(), verts.begin());
-	std::copy(indices.begin(), indices.end(), inds.begin());
-
-	glGenBuffers(1, &VBO);
-	glGenBuffers(1, &VIO);
-	glGenVertexArrays(1, &VAO);
-	glBindBuffer(GL_ARRAY_BUFFER, VBO);
-	glBufferData(GL_ARRAY_BUFFER, verts.size() * sizeof(Vertex), verts.data(), GL_STATIC_DRAW);
-	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, VIO);
-	glBufferData(GL_ELEMENT_ARRAY_BUFFER, inds.size() * sizeof(uint32_t), inds.data(), GL_STATIC_DRAW);
-}
-
-Mesh::Mesh(const Mesh& other)
-{
-	verts.resize(other.verts.size());
-	inds.resize(other.inds.size());
-	std::copy(other.verts.begin(), other.verts.end(), verts.begin());
-	std::copy(other.inds.begin(), other.inds.end(), inds.begin());
-
-	glGenBuffers(1, &VBO);
-	glGenBuffers(1, &VIO);
-	glGenVertexArrays(1, &VAO);
-	glBindBuffer(GL_ARRAY_BUFFER, VBO);
-	glBufferData(GL_ARRAY_BUFFER, verts.size() * sizeof(Vertex), verts.data(), GL_STATIC_DRAW);
-	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, VIO);
-	glBufferData(GL_ELEMENT_ARRAY_BUFFER, inds.size() * sizeof(uint32_t), inds.data(), GL_STATIC_DRAW);
-}
-
-void Mesh::calculate_normals()
-{
-	for (int i = 0; i < inds.size(); i += 3)
-	{
-		glm::vec3 A = verts[inds[i]].pos;
-		glm::vec3 B = verts[inds[i + 1]].pos;
-		glm::vec3 C = verts[inds[i + 2]].pos;
-
-		glm::vec3 contributingNormal = glm::cross(B - A, C - A);
-		float area = glm::length(contributingNormal) / 2.f;
-		contributingNormal = glm::normalize(contributingNormal) * area;
-
-		verts[inds[i]].normal = verts[inds[i]].normal + contributingNormal;
-		verts[inds[i + 1]].normal = verts[inds[i + 1]].normal + contributingNormal;
-		verts[inds[i + 2]].normal = verts[inds[i + 2]].normal + contributingNormal;
-	}
-
-	for (int i = 0; i < verts.size(); i++)
-	{
-		verts[i].normal = glm::normalize(verts[i].normal);
-	}
-
-	glBindBuffer(GL_ARRAY_BUFFER, VBO);
-	glBufferData(GL_ARRAY_BUFFER, verts.size() * sizeof(Vertex), verts.data(), GL_STATIC_DRAW);
-	glBindBuffer(GL_ARRAY_BUFFER, NULL);
-}
-
-void Mesh::BindBuffers()
-{
-	glBindVertexArray(VAO);
-
-	glBindBuffer(GL_ARRAY_BUFFER, VBO);
-	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, VIO);
-
-
-	GLintptr vertex_position_offset = offsetof(Vertex, pos);
-	GLintptr vertex_normal_offset = offsetof(Vertex, normal);
-
-	glEnableVertexAttribArray(0);
-	glEnableVertexAttribArray(1);
-	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (GLvoid*)vertex_position_offset);
-	glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (GLvoid*)vertex_normal_offset);
-}
-
-void Mesh::ClearBinds()
-{
-	glBindVertexArray(NULL);
-	glBindBuffer(GL_ARRAY_BUFFER, NULL);
-	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, NULL);
-	glDisableVertexAttribArray(0);
-	glDisableVertexAttribArray(1);
-}
+#include <cstdio>
 
 bool OpenGLAPI::GLInit(GLFWwindow** outWindow, int window_width, int window_height, const char* app_name)
 {
@@ -121,11 +37,35 @@ bool OpenGLAPI::GLCompileShader(const char* shader_source, unsigned int type, un
     const char* shaderCode = shader_source;
     glShaderSource(shader, 1, &shaderCode, NULL);
     glCompileShader(shader);
-    glAttachShader(program, shader);
-    glDeleteShader(shader);
 
+    //status has to be read while the shader still exists, deleting it only flags it until the program is deleted
     int  success;
     glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
+    if (!success)
+    {
+        char info_log[1024];
+        glGetShaderInfoLog(shader, sizeof(info_log), NULL, info_log);
+        printf("shader compilation failed:\n%s\n", info_log);
+    }
+
+    glAttachShader(program, shader);
+    glDeleteShader(shader);
+
+    return success;
+}
+
+bool OpenGLAPI::GLLinkProgram(unsigned int program)
+{
+    glLinkProgram(program);
+
+    int success;
+    glGetProgramiv(program, GL_LINK_STATUS, &success);
+    if (!success)
+    {
+        char info_log[1024];
+        glGetProgramInfoLog(program, sizeof(info_log), NULL, info_log);
+        printf("program link failed:\n%s\n", info_log);
+    }
 
     return success;
 }
@@ -134,51 +74,7 @@ Mesh OpenGLAPI::GenerateSphereMesh(float radius, int rings, int slices)
 {
 	std::vector<Vertex> vertices;
 	std::vector<uint32_t> indices;
-
-	float x, y, z, xy;
-	float nx, ny, nz, lengthInv = 1.0f / radius;
-	float s, t;
-
-	float sectorStep = 2 * glm::pi<double>() / rings;
-	float stackStep = glm::pi<double>() / slices;
-	float sectorAngle, stackAngle;
-
-	for (int i = 0; i <= slices; ++i)
-	{
-		stackAngle = glm::pi<double>() / 2 - i * stackStep;
-		xy = radius * glm::cos(stackAngle);
-		z = radius * glm::sin(stackAngle);
-
-		for (int j = 0; j <= rings; ++j)
-		{
-			sectorAngle = j * sectorStep;
-			x = xy * glm::cos(sectorAngle);
-			y = xy * glm::sin(sectorAngle);
-			vertices.push_back({ glm::vec3(x, y, z), glm::vec3(x * lengthInv, y * lengthInv, z * lengthInv) });
-		}
-	}
-
-	for (int i = 0; i < slices; ++i)
-	{
-		int k1 = i * (rings + 1);
-		int k2 = k1 + rings + 1;
-
-		for (int j = 0; j < rings; ++j, ++k1, ++k2)
-		{
-			if (i != 0)
-			{
-				indices.push_back(k1);
-				indices.push_back(k2);
-				indices.push_back(k1 + 1);
-			}
-			if (i != (slices - 1))
-			{
-				indices.push_back(k1 + 1);
-				indices.push_back(k2);
-				indices.push_back(k2 + 1);
-			}
-		}
-	}
+	Geometry::GenerateSphere(radius, rings, slices, vertices, indices);
 
 	return Mesh(vertices, indices);
-}
\ No newline at end of file
+}
@@ -0,0 +1,231 @@
+#include "GLBackend.h"
+#include <cstddef>
+
+static const GLbitfield stream_flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+static const GLbitfield readback_flags = GL_MAP_READ_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+
+GLBackend::GLBackend()
+{
+	glEnable(GL_MULTISAMPLE);
+	glEnable(GL_DEPTH_TEST);
+}
+
+size_t GLBackend::UniformAlignment()
+{
+	GLint alignment = 0;
+	glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+	return alignment;
+}
+
+size_t GLBackend::StorageAlignment()
+{
+	GLint alignment = 0;
+	glGetIntegerv(GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT, &alignment);
+	return alignment;
+}
+
+uint32_t GLBackend::CreateBuffer(size_t bytes, bool gpu_written)
+{
+	GLuint buffer;
+	glCreateBuffers(1, &buffer);
+	glNamedBufferData(buffer, bytes, nullptr, gpu_written ? GL_DYNAMIC_COPY : GL_STATIC_DRAW);
+	return buffer;
+}
+
+//persistent and coherent, writes need neither a flush nor an unmap before the draws see them
+uint32_t GLBackend::CreateMappedBuffer(size_t bytes, void** out_mapped)
+{
+	GLuint buffer;
+	glCreateBuffers(1, &buffer);
+	glNamedBufferStorage(buffer, bytes, nullptr, stream_flags);
+	*out_mapped = glMapNamedBufferRange(buffer, 0, bytes, stream_flags);
+	return buffer;
+}
+
+//client storage hints that the CPU is the one reading it, it is mapped coherent so a fence is all the synchronization needed
+uint32_t GLBackend::CreateReadbackBuffer(size_t bytes, void** out_mapped)
+{
+	GLuint buffer;
+	glCreateBuffers(1, &buffer);
+	glNamedBufferStorage(buffer, bytes, nullptr, readback_flags | GL_CLIENT_STORAGE_BIT);
+	*out_mapped = glMapNamedBufferRange(buffer, 0, bytes, readback_flags);
+	return buffer;
+}
+
+void GLBackend::UploadBuffer(uint32_t buffer, size_t offset, const void* data, size_t bytes)
+{
+	glNamedBufferSubData(buffer, offset, bytes, data);
+}
+
+void GLBackend::CopyBuffer(uint32_t source, uint32_t destination, size_t bytes)
+{
+	glCopyNamedBufferSubData(source, destination, 0, 0, bytes);
+}
+
+void GLBackend::ReadBuffer(uint32_t buffer, size_t offset, void* data, size_t bytes)
+{
+	glGetNamedBufferSubData(buffer, offset, bytes, data);
+}
+
+void GLBackend::DeleteBuffer(uint32_t buffer)
+{
+	//deleting a buffer unmaps it
+	glDeleteBuffers(1, &buffer);
+}
+
+//the vertex layout is recorded into the VAO once, drawing only binds the VAO and the instance range
+uint32_t GLBackend::CreateVertexArray(VertexFormat format, uint32_t vertex_buffer, size_t stride, uint32_t index_buffer)
+{
+	GLuint VAO;
+	glCreateVertexArrays(1, &VAO);
+	SetVertexArrayBuffers(VAO, vertex_buffer, stride, index_buffer);
+
+	//binding 0, per vertex position and normal, meshes start at their base vertex
+	if (format == VertexFormat::Packed)
+	{
+		//normalized to [0, 1] within the AABB and to [-1, 1] on the octahedron
+		glVertexArrayAttribFormat(VAO, 0, 3, GL_UNSIGNED_SHORT, GL_TRUE, offsetof(PackedVertex, pos));
+		glVertexArrayAttribFormat(VAO, 1, 2, GL_SHORT, GL_TRUE, offsetof(PackedVertex, normal));
+	}
+	else
+	{
+		glVertexArrayAttribFormat(VAO, 0, 3, GL_FLOAT, GL_FALSE, offsetof(Vertex, pos));
+		glVertexArrayAttribFormat(VAO, 1, 3, GL_FLOAT, GL_FALSE, offsetof(Vertex, normal));
+	}
+	glVertexArrayAttribBinding(VAO, 0, 0);
+	glVertexArrayAttribBinding(VAO, 1, 0);
+	glEnableVertexArrayAttrib(VAO, 0);
+	glEnableVertexArrayAttrib(VAO, 1);
+
+	//binding 1, rotation, position, scale and color of InstanceData advancing once per instance,
+	//the buffer is attached at draw time
+	const GLint sizes[] = { 4, 3, 3, 3 };
+	GLuint offset = 0;
+	for (GLuint i = 0; i < 4; i++)
+	{
+		glVertexArrayAttribFormat(VAO, 2 + i, sizes[i], GL_FLOAT, GL_FALSE, offset);
+		glVertexArrayAttribBinding(VAO, 2 + i, 1);
+		glEnableVertexArrayAttrib(VAO, 2 + i);
+		offset += sizes[i] * sizeof(float);
+	}
+	glVertexArrayBindingDivisor(VAO, 1, 1);
+
+	return VAO;
+}
+
+void GLBackend::SetVertexArrayBuffers(uint32_t vertex_array, uint32_t vertex_buffer, size_t stride, uint32_t index_buffer)
+{
+	glVertexArrayElementBuffer(vertex_array, index_buffer);
+	glVertexArrayVertexBuffer(vertex_array, 0, vertex_buffer, 0, static_cast<GLsizei>(stride));
+}
+
+void GLBackend::DeleteVertexArray(uint32_t vertex_array)
+{
+	glDeleteVertexArrays(1, &vertex_array);
+}
+
+void GLBackend::DeleteProgram(uint32_t program)
+{
+	glDeleteProgram(program);
+}
+
+void GLBackend::SetUniformVec4(uint32_t program, int location, const glm::vec4* values, int count)
+{
+	glProgramUniform4fv(program, location, count, glm::value_ptr(values[0]));
+}
+
+void GLBackend::SetUniformInt(uint32_t program, int location, int32_t value)
+{
+	glProgramUniform1i(program, location, value);
+}
+
+void GLBackend::SetUniformUint(uint32_t program, int location, uint32_t value)
+{
+	glProgramUniform1ui(program, location, value);
+}
+
+void GLBackend::UseProgram(uint32_t program)
+{
+	glUseProgram(program);
+}
+
+void GLBackend::BindVertexArray(uint32_t vertex_array)
+{
+	glBindVertexArray(vertex_array);
+}
+
+void GLBackend::BindVertexBuffer(uint32_t binding, uint32_t buffer, size_t offset, size_t stride)
+{
+	glBindVertexBuffer(binding, buffer, offset, static_cast<GLsizei>(stride));
+}
+
+void GLBackend::BindUniformRange(uint32_t index, uint32_t buffer, size_t offset, size_t bytes)
+{
+	glBindBufferRange(GL_UNIFORM_BUFFER, index, buffer, offset, bytes);
+}
+
+void GLBackend::BindStorageRange(uint32_t index, uint32_t buffer, size_t offset, size_t bytes)
+{
+	glBindBufferRange(GL_SHADER_STORAGE_BUFFER, index, buffer, offset, bytes);
+}
+
+void GLBackend::Viewport(int width, int height)
+{
+	glViewport(0, 0, width, height);
+}
+
+void GLBackend::Clear(glm::vec3 color)
+{
+	glClearColor(color.r, color.g, color.b, 1.f);
+	glClearDepth(1.f);
+	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+}
+
+//into a pixel pack buffer glReadPixels only queues the copy, RGBA rows are 4 byte aligned at any width
+void GLBackend::ReadFramebuffer(uint32_t buffer, int width, int height)
+{
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, buffer);
+	glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+}
+
+void GLBackend::DrawInstanced(uint32_t first_index, uint32_t index_count, uint32_t base_vertex, uint32_t base_instance, uint32_t instance_count)
+{
+	const void* indices = reinterpret_cast<const void*>(first_index * sizeof(uint32_t));
+	glDrawElementsInstancedBaseVertexBaseInstance(GL_TRIANGLES, static_cast<GLsizei>(index_count), GL_UNSIGNED_INT, indices, instance_count,
+		static_cast<GLint>(base_vertex), base_instance);
+}
+
+void GLBackend::MultiDrawIndirect(uint32_t command_buffer, size_t first_command, size_t count)
+{
+	glBindBuffer(GL_DRAW_INDIRECT_BUFFER, command_buffer);
+	const void* commands = reinterpret_cast<const void*>(first_command * sizeof(DrawElementsIndirectCommand));
+	glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, commands, static_cast<GLsizei>(count), 0);
+	glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+}
+
+void GLBackend::DispatchCompute(uint32_t groups)
+{
+	glDispatchCompute(groups, 1, 1);
+}
+
+void GLBackend::ComputeBarrier()
+{
+	glMemoryBarrier(GL_COMMAND_BARRIER_BIT | GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT | GL_BUFFER_UPDATE_BARRIER_BIT);
+}
+
+RenderFence GLBackend::InsertFence()
+{
+	return glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+}
+
+bool GLBackend::WaitFence(RenderFence fence, uint64_t timeout_ns)
+{
+	GLbitfield flags = timeout_ns > 0 ? GL_SYNC_FLUSH_COMMANDS_BIT : 0;
+	return glClientWaitSync(static_cast<GLsync>(fence), flags, timeout_ns) != GL_TIMEOUT_EXPIRED;
+}
+
+void GLBackend::DeleteFence(RenderFence fence)
+{
+	glDeleteSync(static_cast<GLsync>(fence));
+}
@@ -0,0 +1,50 @@
+#pragma once
+#include "GLAPI.h"
+#include "RenderBackend.h"
+
+//RenderBackend on the current GL 4.6 context, names are GL's own and every call maps to one or two GL calls
+class GLBackend : public RenderBackend
+{
+public:
+	//the context has to be current, depth testing and multisampling are on from here
+	GLBackend();
+
+	size_t UniformAlignment() override;
+	size_t StorageAlignment() override;
+
+	uint32_t CreateBuffer(size_t bytes, bool gpu_written = false) override;
+	uint32_t CreateMappedBuffer(size_t bytes, void** out_mapped) override;
+	uint32_t CreateReadbackBuffer(size_t bytes, void** out_mapped) override;
+	void UploadBuffer(uint32_t buffer, size_t offset, const void* data, size_t bytes) override;
+	void CopyBuffer(uint32_t source, uint32_t destination, size_t bytes) override;
+	void ReadBuffer(uint32_t buffer, size_t offset, void* data, size_t bytes) override;
+	void DeleteBuffer(uint32_t buffer) override;
+
+	uint32_t CreateVertexArray(VertexFormat format, uint32_t vertex_buffer, size_t stride, uint32_t index_buffer) override;
+	void SetVertexArrayBuffers(uint32_t vertex_array, uint32_t vertex_buffer, size_t stride, uint32_t index_buffer) override;
+	void DeleteVertexArray(uint32_t vertex_array) override;
+
+	void DeleteProgram(uint32_t program) override;
+	void SetUniformVec4(uint32_t program, int location, const glm::vec4* values, int count) override;
+	void SetUniformInt(uint32_t program, int location, int32_t value) override;
+	void SetUniformUint(uint32_t program, int location, uint32_t value) override;
+
+	void UseProgram(uint32_t program) override;
+	void BindVertexArray(uint32_t vertex_array) override;
+	void BindVertexBuffer(uint32_t binding, uint32_t buffer, size_t offset, size_t stride) override;
+	void BindUniformRange(uint32_t index, uint32_t buffer, size_t offset, size_t bytes) override;
+	void BindStorageRange(uint32_t index, uint32_t buffer, size_t offset, size_t bytes) override;
+
+	void Viewport(int width, int height) override;
+	void Clear(glm::vec3 color) override;
+	void ReadFramebuffer(uint32_t buffer, int width, int height) override;
+
+	void DrawInstanced(uint32_t first_index, uint32_t index_count, uint32_t base_vertex, uint32_t base_instance, uint32_t instance_count) override;
+	void MultiDrawIndirect(uint32_t command_buffer, size_t first_command, size_t count) override;
+	void DispatchCompute(uint32_t groups) override;
+	void ComputeBarrier() override;
+
+	RenderFence InsertFence() override;
+	bool WaitFence(RenderFence fence, uint64_t timeout_ns) override;
+	void DeleteFence(RenderFence fence) override;
+};
@@ -1,25 +1,67 @@
 #pragma once
-#include "EntityComponents.h"
-#include "FileManager.h"
-
-const char* vertex_shader = "#version 460 core\nlayout(location = 0) in vec3 vecPos;layout(location = 1) in vec3 vecNorm;layout(location = 0) out vec3 fragColor;layout(location = 1) out vec3 fragNorm;layout(location = 2) out vec3 position;layout(location = 0) uniform mat4 mWorld;layout(location = 1) uniform mat4 mProj;layout(location = 2) uniform mat4 mView;layout(location = 3) uniform vec3 scale;layout(location = 4) uniform vec3 color;void main(){gl_Position = mProj * mView * mWorld * vec4(scale * vecPos, 1.0);fragColor = color;fragNorm = vecNorm;position = vecPos;}";
-const char* fragment_shader = "#version 460 core\nlayout(location = 0) in vec3 fragColor;layout(location = 1) in vec3 fragNorm;layout(location = 2) in vec3 position;out vec4 outColor;void main(){const vec3 lightPos = vec3(25, 50, 0);float diffuse = max(0.65, dot(normalize(fragNorm), normalize(lightPos - position)));outColor = vec4(fragColor * diffuse, 1.0);}";
+#include <cstdio>
+#include "GLBackend.h"
+#include "FrameCapture.h"
+#include "GeometryArena.h"
+#include "Renderer.h"
+#include "StaticBatch.h"
+#include "Simulation.h"
+#include "SimulationLoop.h"
+#include "Profiler.h"
+#include "ProgramCache.h"
+#include "FileWatcher.h"
+#include "BattleView.h"
+
+//the CMake build reads the shaders from the source tree so saving them there reloads them, Visual Studio
+//starts the game in the project directory and reads them relative to it
+#ifdef ARCHERS_SHADER_DIR
+#define SHADER_DIRECTORY ARCHERS_SHADER_DIR "/"
+#else
+#define SHADER_DIRECTORY "Shaders/"
+#endif
+
+const char* vertex_shader_path = SHADER_DIRECTORY "default.vert";
+const char* fragment_shader_path = SHADER_DIRECTORY "default.frag";
+//archers as ray traced spheres on camera facing quads
+const char* impostor_vertex_path = SHADER_DIRECTORY "impostor.vert";
+const char* impostor_fragment_path = SHADER_DIRECTORY "impostor.frag";
+const char* packed_vertex_define = "#define PACKED_VERTEX\n";
+//frustum culling of every instance on the GPU
+const char* cull_shader_path = SHADER_DIRECTORY "cull.comp";
 
 class ArchersGame
 {
 public:
-	ArchersGame()
+	//the camera frames the field of the battle, larger battles are seen from further away
+	ArchersGame(const SimulationSettings& settings = SimulationSettings()) : simulation(settings)
 	{
-
+		view_scale = settings.field_extent / SimulationSettings().field_extent;
+		camera_position = BattleView::CameraPosition(camera_angle, view_scale);
 	}
 
 	~ArchersGame()
 	{
-		delete archer;
+		simulation_loop.Stop();
+		delete shader_watcher;
+		delete program_cache;
+		delete static_batcher;
+		delete renderer;
+		delete stream_buffer;
+		delete archer_lods;
 		delete arrow;
 		delete tile;
 		ent_registry.clear();
-		glDeleteProgram(shaderProgram);
+		delete impostor_quad;
+		GeometryArena::Destroy();
+		delete frame_capture;
+		if (backend != nullptr)
+		{
+			backend->DeleteProgram(shaderProgram);
+			backend->DeleteProgram(packedProgram);
+			backend->DeleteProgram(impostorProgram);
+			backend->DeleteProgram(cullProgram);
+		}
+		delete backend;
 		glfwDestroyWindow(window);
 		glfwTerminate();
 	}
@@ -27,19 +69,58 @@ public:
 	bool Prepare()
 	{
 		bool res = OpenGLAPI::GLInit(&window, 1280, 720, "Archers");
-		shaderProgram = glCreateProgram();
-		res = res & OpenGLAPI::GLCompileShader(vertex_shader, GL_VERTEX_SHADER, shaderProgram);
-		res = res & OpenGLAPI::GLCompileShader(fragment_shader, GL_FRAGMENT_SHADER, shaderProgram);
 
 		if (res)
 		{
-			glEnable(GL_MULTISAMPLE);
-			glEnable(GL_DEPTH_TEST);
-			glLinkProgram(shaderProgram);
-			camera = ent_registry.create();
-			ent_registry.emplace<Position>(camera, camera_sp);
+			//everything drawn from here on goes through the backend, meshes included
+			backend = new GLBackend();
+			GeometryArena::Create(*backend);
+
+			//the first launch compiles and stores the program binary, later ones load it
+			program_cache = new ProgramCache("program_cache");
+			shaderProgram = LoadShaderProgram(vertex_shader_path, fragment_shader_path);
+			bool warm = program_cache->LastWasHit();
+			double seconds = program_cache->LastSeconds();
+			packedProgram = LoadShaderProgram(vertex_shader_path, fragment_shader_path, packed_vertex_define);
+			warm = warm && program_cache->LastWasHit();
+			seconds += program_cache->LastSeconds();
+			impostorProgram = LoadShaderProgram(impostor_vertex_path, impostor_fragment_path);
+			warm = warm && program_cache->LastWasHit();
+			seconds += program_cache->LastSeconds();
+			res = shaderProgram != 0 && packedProgram != 0 && impostorProgram != 0;
+			if (res)
+			{
+				printf("shader programs %s in %.2f ms\n", warm ? "loaded from cache (warm)" : "compiled (cold)", seconds * 1e3);
+			}
+
+			//without it everything is culled on the CPU
+			cullProgram = LoadComputeProgram(cull_shader_path);
+			if (cullProgram == 0)
+				printf("GPU culling unavailable\n");
+
+			//saving a shader swaps the program in the running game
+			shader_watcher = new FileWatcher();
+			shader_watcher->Watch(vertex_shader_path);
+			shader_watcher->Watch(fragment_shader_path);
+			shader_watcher->Watch(impostor_vertex_path);
+			shader_watcher->Watch(impostor_fragment_path);
+			shader_watcher->Watch(cull_shader_path);
+		}
+
+		if (res)
+		{
+			//frames are paced by the display, simulation keeps its own fixed rate
+			glfwSwapInterval(1);
+			stream_buffer = new StreamBuffer(*backend);
+			renderer = new InstancedRenderer(*backend, *stream_buffer);
+			frame_capture = new FrameCapture(*backend);
+			renderer->SetCullProgram(cullProgram);
+			renderer->SetGpuCulling(gpu_culling);
 			LoadAssets();
-			SetupField(10, 10, 10);
+			SetupField(BattleView::field_tiles, BattleView::field_tiles, BattleView::tile_size);
+			//the field never changes, it is drawn as one merged mesh
+			static_batcher = new StaticBatcher();
+			static_batcher->Build(ent_registry, VertexFormat::Packed);
 		}
 
 		return res;
@@ -51,7 +132,9 @@ public:
 		//resize viewport
 		glfwSetWindowSizeCallback(window, [](GLFWwindow* window, int new_width, int new_height) 
 		{
-			glViewport(0, 0, new_width, new_height);
+			ArchersGame* context = static_cast<ArchersGame*>(glfwGetWindowUserPointer(window));
+			context->backend->Viewport(new_width, new_height);
+			context->renderer->SetViewportHeight(new_height);
 		});
 		glfwSetKeyCallback(window, [](GLFWwindow* win, int key, int scancode, int action, int mods)
 		{
@@ -68,6 +151,46 @@ public:
 				case GLFW_KEY_RIGHT:
 					context->UpdateCamera(1);
 					break;
+				//simulation speed
+				case GLFW_KEY_P:
+					if (action == GLFW_PRESS)
+						context->simulation_loop.SetPaused(!context->simulation_loop.IsPaused());
+					break;
+				case GLFW_KEY_MINUS:
+					context->simulation_loop.SetScale(glm::max(context->simulation_loop.Scale() * 0.5, 0.125));
+					break;
+				case GLFW_KEY_EQUAL:
+					context->simulation_loop.SetScale(glm::min(context->simulation_loop.Scale() * 2.0, 8.0));
+					break;
+				//profiling
+				case GLFW_KEY_F9:
+					if (action == GLFW_PRESS)
+						context->ToggleTrace();
+					break;
+				case GLFW_KEY_C:
+					if (action == GLFW_PRESS)
+						context->ToggleCulling();
+					break;
+				case GLFW_KEY_G:
+					if (action == GLFW_PRESS)
+						context->ToggleGpuCulling();
+					break;
+				case GLFW_KEY_L:
+					if (action == GLFW_PRESS)
+						context->ToggleLod();
+					break;
+				case GLFW_KEY_I:
+					if (action == GLFW_PRESS)
+						context->ToggleImpostors();
+					break;
+				case GLFW_KEY_F10:
+					if (action == GLFW_PRESS)
+						context->PrintRenderStats();
+					break;
+				case GLFW_KEY_F11:
+					if (action == GLFW_PRESS)
+						context->ToggleCapture();
+					break;
 				default:
 					break;
 				}
@@ -77,310 +200,375 @@ public:
 
 	void GameCycle()
 	{
-		int vw, vh, frames = 0;;
+		int vw, vh;
 		glfwGetFramebufferSize(window, &vw, &vh);
 		float aspect = vw / (float)vh;
-		//glm::mat4 projection = glm::perspective(45.f, aspect, 0.01f, 1000.f);
-		glm::mat4 projection = glm::ortho(-65.f * aspect, 65.f * aspect, -65.f, 65.f, 0.01f, 200.f);
+		glm::mat4 projection = BattleView::Projection(aspect, view_scale);
+		renderer->SetViewportHeight(vh);
+		Profiler::SetThreadName("Main");
+
+		//the next tick is simulated while the last one is drawn, the registry belongs to the simulation thread from here on
+		if (threaded_simulation)
+			simulation_loop.Start();
 
 		while (!glfwWindowShouldClose(window))
 		{
-			double frame_start = glfwGetTime();
-			double frame_end;
-			glm::mat4 view = glm::lookAt(ent_registry.get<Position>(camera).coord, glm::vec3(0, 0, 0), glm::vec3(0, 1, 0));
+			PROFILE_ZONE("Frame");
 
-			if (archers_count < 40 && frames % 2 == 0)
 			{
-				archers_count += 2;
-				SpawnArchers();
+				PROFILE_ZONE("PollEvents");
+				glfwPollEvents();
 			}
 
-			glClearColor(0.73, 0.84, 0.95, 1.0);
-			glClearDepth(1.f);
-			glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+			if (simulation_loop.IsThreaded() == false)
+				simulation_loop.Advance();
 
-			glUseProgram(shaderProgram);
-			UpdateSimulation();
+			if (shader_watcher->Poll())
+				ReloadShaders();
 
-			//mProj
-			glUniformMatrix4fv(1, 1, GL_FALSE, glm::value_ptr(projection));
-			//mView
-			glUniformMatrix4fv(2, 1, GL_FALSE, glm::value_ptr(view));
-			DrawFrame();
+			{
+				PROFILE_ZONE("DrawFrame");
+				glm::mat4 view = BattleView::View(camera_position);
+
+				backend->Clear(glm::vec3(0.73f, 0.84f, 0.95f));
+
+				stream_buffer->BeginFrame();
+				renderer->Begin();
+				renderer->SetCamera(projection, view);
+				drawn_snapshot = &snapshots.Read();
+				DrawFrame(*drawn_snapshot, drawn_snapshot->Alpha(glfwGetTime()));
+				stream_buffer->EndFrame();
+			}
 
-			glfwSwapBuffers(window);
-			frames++;
+			if (frame_capture->IsCapturing())
+				frame_capture->Capture();
 
-			do
 			{
-				glfwPollEvents();
-				frame_end = glfwGetTime();
-			} while (frame_end - frame_start < 0.05);
+				PROFILE_ZONE("SwapBuffers");
+				glfwSwapBuffers(window);
+			}
+		}
+
+		simulation_loop.Stop();
+
+		//a capture still running when the window closes is written out
+		if (Profiler::IsEnabled())
+			ToggleTrace();
+		if (frame_capture->IsCapturing())
+			ToggleCapture();
+	}
+
+	//simulation ticks per second, rendering runs at display rate and interpolates between ticks, set before GameCycle
+	void SetTickRate(double ticks_per_second)
+	{
+		simulation.Clock().SetTickRate(ticks_per_second);
+	}
+
+	//off runs the simulation on the render thread between frames, as it was before the pipelining
+	void SetThreadedSimulation(bool enable)
+	{
+		threaded_simulation = enable;
+	}
+
+	//starts capturing zones, or stops and writes the capture to trace_path, open it in chrome://tracing or ui.perfetto.dev
+	void ToggleTrace()
+	{
+		if (Profiler::IsEnabled())
+		{
+			Profiler::SetEnabled(false);
+			Profiler::WriteTrace(trace_path.c_str());
+			Profiler::Clear();
+		}
+		else
+		{
+			Profiler::SetEnabled(true);
+		}
+	}
+
+	//starts recording the window to capture_target at its current size, or stops and waits for the frames in flight
+	void ToggleCapture()
+	{
+		if (frame_capture->IsCapturing())
+		{
+			frame_capture->Stop();
+			CaptureStats stats = frame_capture->Stats();
+			printf("captured %llu frames at %dx%d to %s, %llu dropped, %llu failed, %.3f ms per frame on the render thread (max %.3f ms)\n",
+				static_cast<unsigned long long>(stats.written), frame_capture->Width(), frame_capture->Height(), capture_target.c_str(),
+				static_cast<unsigned long long>(stats.dropped), static_cast<unsigned long long>(stats.failed),
+				stats.captured + stats.dropped > 0 ? stats.render_seconds * 1e3 / (stats.captured + stats.dropped) : 0.0, stats.max_render_seconds * 1e3);
+		}
+		else
+		{
+			int vw, vh;
+			glfwGetFramebufferSize(window, &vw, &vh);
+			frame_capture->Start(capture_target, vw, vh);
+		}
+	}
+
+	//compiles the shader files again, a program is kept when its new sources don't compile or link
+	void ReloadShaders()
+	{
+		ReloadProgram(shaderProgram, vertex_shader_path, fragment_shader_path);
+		ReloadProgram(packedProgram, vertex_shader_path, fragment_shader_path, packed_vertex_define);
+		ReloadProgram(impostorProgram, impostor_vertex_path, impostor_fragment_path);
+
+		uint32_t reloaded = LoadComputeProgram(cull_shader_path);
+		if (reloaded == 0)
+		{
+			printf("reloading %s failed, keeping the previous program\n", cull_shader_path);
+			return;
+		}
+		program_cache->Replaced(cullProgram);
+		backend->DeleteProgram(cullProgram);
+		cullProgram = reloaded;
+		renderer->SetCullProgram(cullProgram);
+	}
+
+	//archers drawn as impostors or as sphere meshes
+	void SetImpostors(bool enable)
+	{
+		impostors = enable;
+	}
+
+	void ToggleImpostors()
+	{
+		impostors = !impostors;
+	}
+
+	void ToggleCulling()
+	{
+		culling = !culling;
+		renderer->SetCulling(culling);
+	}
+
+	//archers, arrows and the field culled by cull.comp and drawn with glMultiDrawElementsIndirect
+	void SetGpuCulling(bool enable)
+	{
+		gpu_culling = enable;
+		if (renderer != nullptr)
+			renderer->SetGpuCulling(gpu_culling);
+	}
+
+	void ToggleGpuCulling()
+	{
+		SetGpuCulling(!gpu_culling);
+	}
+
+	void ToggleLod()
+	{
+		lod = !lod;
+		renderer->SetLod(lod);
+	}
+
+	void PrintRenderStats()
+	{
+		//the GPU path only knows what it drew after reading it back, checked against the CPU culler on the way
+		if (renderer->GpuCulling())
+		{
+			GpuCullCheck check = renderer->VerifyGpuCulling();
+			printf("GPU culling: %zu indirect draws, %zu visible, %zu draws differ from the CPU reference\n", check.draws, check.visible,
+				check.mismatched_draws);
+		}
+
+		const StreamStats& stream = stream_buffer->Stats();
+		printf("draw calls: %zu, instances: %zu, %zu static entities merged into %zu batches\n", renderer->DrawCalls(), renderer->Instances(),
+			static_batcher->MergedEntities(), static_batcher->Batches());
+		printf("triangles: %zu, LOD %s, archers drawn as %s\n", renderer->Triangles(), lod ? "on" : "off", impostors ? "impostors" : "meshes");
+		size_t archer_bytes = 0;
+		for (Mesh* level : archer_lods->meshes)
+		{
+			archer_bytes += level->VertexBytes();
 		}
+		printf("vertex buffers: %zu bytes of archer LODs, %zu bytes of static batches\n", archer_bytes, static_batcher->VertexBytes());
+		ArenaStats arena = GeometryArena::Get().Stats();
+		printf("geometry arena: %zu of %zu vertex bytes, %zu of %zu index bytes, %zu index ranges shared saving %zu bytes, grown %zu times (%zu vertex, %zu index)\n",
+			arena.vertex_bytes, arena.vertex_capacity_bytes, arena.index_bytes, arena.index_capacity_bytes, arena.shared_index_ranges, arena.shared_index_bytes,
+			arena.vertex_grows + arena.index_grows, arena.vertex_grows, arena.index_grows);
+		printf("state changes: %llu requested, %llu issued\n", static_cast<unsigned long long>(renderer->State().Requested()),
+			static_cast<unsigned long long>(renderer->State().Issued()));
+		printf("culling %s: %zu tested, %zu visible, %zu culled, %d spheres per test\n", culling ? "on" : "off", renderer->Culling().tested,
+			renderer->Culling().visible, renderer->Culling().Culled(), FrustumCuller::Lanes());
+		printf("streamed: %zu bytes last frame, %.1f bytes/frame average, %llu fence stalls (%.3f ms), %llu grows\n", stream.frame_bytes,
+			stream.frames > 0 ? static_cast<double>(stream.total_bytes) / stream.frames : 0.0, static_cast<unsigned long long>(stream.fence_stalls),
+			stream.stall_seconds * 1e3, static_cast<unsigned long long>(stream.grows));
+		if (drawn_snapshot != nullptr)
+			printf("snapshot: tick %llu, %zu objects, simulated on the %s thread\n", static_cast<unsigned long long>(drawn_snapshot->tick),
+				drawn_snapshot->objects.size(), simulation_loop.IsThreaded() ? "simulation" : "render");
+	}
+
+	void SetTracePath(const std::string& path)
+	{
+		trace_path = path;
+	}
+
+	//see FrameCapture::Start for the kinds of target
+	void SetCaptureTarget(const std::string& target)
+	{
+		capture_target = target;
 	}
 
 	//Camera position control with arrows
 	void UpdateCamera(float delta)
 	{
 		camera_angle += delta;
-		glm::quat q = glm::quat_cast(glm::mat3(1.f));
-		q = q * glm::angleAxis(glm::radians(camera_angle), glm::vec3(0, 1, 0));
-		q = q * glm::angleAxis(glm::radians(0.f), glm::vec3(1, 0, 0));
-		q = q * glm::angleAxis(glm::radians(0.f), glm::vec3(0, 0, 1));
-		ent_registry.get<Position>(camera) = q * camera_sp;
+		camera_position = BattleView::CameraPosition(camera_angle, view_scale);
 	}
 
 private:
-	//update objects on scene
-	void UpdateSimulation()
+	//0 when a file is missing or the sources don't compile or link, defines go right after the #version line
+	uint32_t LoadShaderProgram(const char* vertex_path, const char* fragment_path, const char* defines = "")
 	{
-		//move objects according to their linear velocity
-		for (auto object : ent_registry.view<Velocity>())
+		std::string vertex_source = FileManager::ReadTextFile(vertex_path);
+		std::string fragment_source = FileManager::ReadTextFile(fragment_path);
+		if (vertex_source.empty() || fragment_source.empty())
 		{
-			glm::vec3 new_pos = ent_registry.get<Position>(object).coord + ent_registry.get<Velocity>(object).vel;
-			if (new_pos.x >= 48.f || new_pos.x <= -48.f)
-			{
-				ent_registry.get<Velocity>(object).vel.x *= -1.f;
-				new_pos = ent_registry.get<Position>(object).coord + ent_registry.get<Velocity>(object).vel;
-			}
-			if (new_pos.z >= 48.f || new_pos.z <= -48.f)
-			{
-				ent_registry.get<Velocity>(object).vel.z *= -1.f;
-				new_pos = ent_registry.get<Position>(object).coord + ent_registry.get<Velocity>(object).vel;
-			}
-
-			ent_registry.get<Position>(object).coord = new_pos;
+			printf("couldn't read %s or %s\n", vertex_path, fragment_path);
+			return 0;
 		}
-		//update projectile trajectories
-		for (auto object : ent_registry.view<Trajectory>())
-		{
-			Trajectory& project_traj = ent_registry.get<Trajectory>(object);
-			project_traj.UpdatePosition(ent_registry.get<Position>(object), ent_registry.get<Orientation>(object));
 
-			if (ent_registry.get<Position>(object).coord.y > 0.f)
-			{
-				for (auto archR : ent_registry.view<Archer>())
-				{
-					if (glm::distance(ent_registry.get<Position>(object).coord, ent_registry.get<Position>(archR).coord) < 1.7f)
-					{
-						ent_registry.get<Health>(archR).Hit(20);
-						ent_registry.destroy(object);
-
-						if (ent_registry.get<Health>(archR).IsGreaterThanZero() == false)
-						{
-							ent_registry.destroy(archR);
-						}
-						break;
-					}
-				}
-			}
-			else
-			{
-				ent_registry.destroy(object);
-			}
-		}
-		ent_registry.compact();
-
-		auto archer_entt = ent_registry.view<Archer>();
-		std::vector<int> targets;
-		std::vector<float> distances;
-		distances.resize(archer_entt.size());
-		targets.resize(distances.size());
-		//update archers behaviours
-		for (int i = 0; i < archer_entt.size(); i++)
+		for (std::string* source : { &vertex_source, &fragment_source })
 		{
-			//check every archer against every other archer, that was not distanced before
-			for (int j = i+1; j < archer_entt.size(); j++)
-			{
-				float distance = glm::length(ent_registry.get<Position>(archer_entt[i]).coord - ent_registry.get<Position>(archer_entt[j]).coord);
-				//if archers are from different teams check for distance
-				if (ent_registry.get<Archer>(archer_entt[i]).IsRed() != ent_registry.get<Archer>(archer_entt[j]).IsRed())
-				{
-					if (distances[i] == 0 || distances[i] > distance)
-					{
-						distances[i] = distance;
-						targets[i] = j;
-					}
-
-					if (distances[j] == 0 || distances[j] > distance)
-					{
-						distances[j] = distance;
-						targets[j] = i;
-					}
-				}
-				//if archers are on the same team, check for collision
-				else
-				{
-					if (distance <= 3.4f)
-					{
-						distances[i] = -1;
-						targets[i] = j;
-						distances[j] = -1;
-						targets[j] = i;
-					}
-				}
-			}
-			//archer's state
-			if (distances[i] != 0.f)
-			{
-				glm::vec3 dir = glm::normalize(glm::vec3(ent_registry.get<Position>(archer_entt[targets[i]]).coord - ent_registry.get<Position>(archer_entt[i]).coord));
-				//friendly collision is top priority
-				if (distances[i] == -1 && glm::dot(ent_registry.get<Velocity>(archer_entt[i]).vel, dir) >= 0)
-				{
-					//move in perpendicular direction from ally
-					ent_registry.get<Velocity>(archer_entt[i]) = glm::cross(glm::vec3(0.f, 1.f, 0.f), glm::vec3(-0.1f - static_cast <float> (rand()) / static_cast <float> (RAND_MAX), 0.f, -0.1f - static_cast <float> (rand()) / static_cast <float> (RAND_MAX)) * dir);
-				}
-				else if (distances[i] > 40.f)
-				{
-					//move closer to foe
-					ent_registry.get<Velocity>(archer_entt[i]) = glm::vec3(1.f, 0.f, 1.f) * dir;
-				}
-				else if (distances[i] > 0 && distances[i] <= 40.f && ent_registry.get<Archer>(archer_entt[i]).CanShoot())
-				{
-					//enemy is close enough, shoot
-					ent_registry.get<Velocity>(archer_entt[i]) = glm::vec3(0.f, 0.f, 0.f);
-					ShootProjectile(archer_entt[i], ent_registry.get<Position>(archer_entt[targets[i]]).coord);
-				}
-				else if (distances[i] > 0)
-				{
-					ent_registry.get<Velocity>(archer_entt[i]) = glm::vec3(0.f, 0.f, 0.f);
-				}
-			}
+			size_t version_end = source->find('\n');
+			source->insert(version_end == std::string::npos ? source->size() : version_end + 1, defines);
 		}
+
+		return program_cache->Load(vertex_source.c_str(), fragment_source.c_str());
 	}
-	
-	void DrawFrame()
+
+	uint32_t LoadComputeProgram(const char* path)
 	{
-		for (auto object : ent_registry.view<MeshComponent>())
+		std::string source = FileManager::ReadTextFile(path);
+		if (source.empty())
 		{
-			MeshComponent& object_mesh = ent_registry.get<MeshComponent>(object);
-			glm::mat4 model = glm::translate(glm::mat4(1.f), ent_registry.get<Position>(object).coord) * glm::mat4_cast(ent_registry.get<Orientation>(object).ori);
-			//mWorld
-			glUniformMatrix4fv(0, 1, GL_FALSE, glm::value_ptr(model));
-			//scale
-			glUniform3fv(3, 1, glm::value_ptr(object_mesh.scale()));
-			//color
-			glUniform3fv(4, 1, glm::value_ptr(object_mesh.color()));
-
-			object_mesh.get()->BindBuffers();
-			glDrawElements(GL_TRIANGLES, object_mesh.get()->NumIndices(), GL_UNSIGNED_INT, NULL);
-			object_mesh.get()->ClearBinds();
+			printf("couldn't read %s\n", path);
+			return 0;
 		}
+
+		return program_cache->LoadCompute(source.c_str());
 	}
 
-	void LoadAssets()
+	void ReloadProgram(unsigned int& program, const char* vertex_path, const char* fragment_path, const char* defines = "")
 	{
-		// 10x10 tiles
-		std::vector<Vertex> tile_vertices = {
-			{{5.f, 0.f, 5.f}, {1.f, 1.f, 1.f}},
-			{{5.f, 0.f, -5.f}, {1.f, 1.f, 1.f}},
-			{{-5.f, 0.f, 5.f}, {1.f, 1.f, 1.f}},
-			{{-5.f, 0.f, -5.f}, {1.f, 1.f, 1.f}},
-			{{5.f, -2.f, 5.f}, {1.f, 1.f, 1.f}},
-			{{5.f, -2.f, -5.f}, {1.f, 1.f, 1.f}},
-			{{-5.f, -2.f, 5.f}, {1.f, 1.f, 1.f}},
-			{{-5.f, -2.f, -5.f}, {1.f, 1.f, 1.f}}
-		};
-		//arrows
-		std::vector<Vertex> arrow_vertices = {
-			{{0.1f, 0.1f, 1.5f}, {1.f, 1.f, 1.f}},
-			{{0.1f, 0.1f, -1.5f}, {1.f, 1.f, 1.f}},
-			{{-0.1f, 0.1f, 1.5f}, {1.f, 1.f, 1.f}},
-			{{-0.1f, 0.1f, -1.5f}, {1.f, 1.f, 1.f}},
-			{{0.1f, -0.1f, 1.5f}, {1.f, 1.f, 1.f}},
-			{{0.1f, -0.1f, -1.5f}, {1.f, 1.f, 1.f}},
-			{{-0.1f, -0.1f, 1.5f}, {1.f, 1.f, 1.f}},
-			{{-0.1f, -0.1f, -1.5f}, {1.f, 1.f, 1.f}}
-		};
-		//indices are shared between tiles and arrows
-		std::vector<uint32_t> indices = {
-			0, 1, 2, 2, 1, 3,
-			6, 5, 4, 7, 5, 6,
-			0, 2, 6, 6, 4, 0,
-			1, 0, 5, 4, 5, 0,
-			5, 7, 1, 3, 1, 7,
-			7, 6, 3, 2, 3, 6
-		};
+		uint32_t reloaded = LoadShaderProgram(vertex_path, fragment_path, defines);
+		if (reloaded == 0)
+		{
+			printf("reloading %s failed, keeping the previous program\n", fragment_path);
+			return;
+		}
 
-		arrow = new Mesh(arrow_vertices, indices);
-		tile = new Mesh(tile_vertices, indices);
-		//arher is a sphere with R=1.7
-		Mesh sphere = OpenGLAPI::GenerateSphereMesh(1.7f, 32, 32);
-		archer = new Mesh(sphere);
-		archer->calculate_normals();
-		tile->calculate_normals();
+		program_cache->Replaced(program);
+		backend->DeleteProgram(program);
+		program = reloaded;
+		printf("%s reloaded in %.2f ms\n", fragment_path, program_cache->LastSeconds() * 1e3);
 	}
 
-	void SetupField(int tilesH, int tilesV, int tileSize)
+	//alpha is the fraction of a tick passed since the snapshot's simulation update
+	void DrawFrame(const RenderSnapshot& snapshot, float alpha)
 	{
-		int startPoint = -(tilesH * tilesV / 2.f) + tileSize/2.f;
-		int posZ = startPoint, posX = startPoint;
+		renderer->SetProgram(shaderProgram);
+		renderer->SetPackedProgram(packedProgram);
+		static_batcher->Submit(*renderer);
 
-		for (int i = 0; i < tilesV; i++)
+		for (const SnapshotObject& object : snapshot.objects)
 		{
-			for (int j = 0; j < tilesH; j++)
+			glm::vec3 pos = glm::mix(object.prev_position, object.position, alpha);
+
+			//a quad the size of the sphere, the scale carries the radius
+			if (impostors && object.mesh == archer)
 			{
-				entt::entity entity = ent_registry.create();
-				ent_registry.emplace<Position>(entity, glm::vec3(posX, 0, posZ));
-				ent_registry.emplace<Orientation>(entity, glm::angleAxis(0.f, glm::vec3(0, 1, 0)));
-				ent_registry.emplace<MeshComponent>(entity, tile, glm::vec3(0.9f), glm::vec3(0.f, 1.f, 0.f));
-				posZ += tileSize;
+				renderer->SetProgram(impostorProgram);
+				renderer->Add(impostor_quad, pos, glm::quat(1.f, 0.f, 0.f, 0.f), object.scale * archer->BoundsRadius(), object.color, object.object, object.version);
+				renderer->SetProgram(shaderProgram);
+				continue;
 			}
-			posZ = startPoint;
-			posX += tileSize;
+
+			glm::quat ori = glm::slerp(object.prev_rotation, object.rotation, alpha);
+			renderer->Add(object.mesh, pos, ori, object.scale, object.color, object.object, object.version);
 		}
+
+		//one instanced draw per mesh
+		renderer->Draw();
 	}
 
-	void SpawnArchers()
+	void LoadAssets()
 	{
-		entt::entity entity = ent_registry.create();
-		ent_registry.emplace<Position>(entity, glm::vec3(-40, 2.5, -40));
-		ent_registry.emplace<Orientation>(entity, glm::angleAxis(0.f, glm::vec3(0, 1, 0)));
-		ent_registry.emplace<MeshComponent>(entity, archer, glm::vec3(1.f), glm::vec3(1.f, 0.f, 0.f));
-		ent_registry.emplace<Archer>(entity, Archer(true));
-		ent_registry.emplace<Health>(entity);
-		ent_registry.emplace<Velocity>(entity, glm::vec3(glm::vec3(0.1f + static_cast <float> (rand()) / static_cast <float> (RAND_MAX), 0.f, 0.1f + static_cast <float> (rand()) / static_cast <float> (RAND_MAX))));
-
-		entt::entity entity2 = ent_registry.create();
-		ent_registry.emplace<Position>(entity2, glm::vec3(40, 2.5, 40));
-		ent_registry.emplace<Orientation>(entity2, glm::angleAxis(0.f, glm::vec3(0, 1, 0)));
-		ent_registry.emplace<MeshComponent>(entity2, archer, glm::vec3(1.f), glm::vec3(0.f, 0.f, 1.f));
-		ent_registry.emplace<Archer>(entity2, Archer(false));
-		ent_registry.emplace<Health>(entity2);
-		ent_registry.emplace<Velocity>(entity2, glm::vec3(glm::vec3(-0.1f - static_cast <float> (rand()) / static_cast <float> (RAND_MAX), 0.f, -0.1f - static_cast <float> (rand()) / static_cast <float> (RAND_MAX))));
+		//10x10 tiles and arrows, boxes with the same indices
+		std::vector<Vertex> tile_vertices;
+		std::vector<Vertex> arrow_vertices;
+		std::vector<uint32_t> indices;
+		Geometry::GenerateBox(glm::vec3(-5.f, -2.f, -5.f), glm::vec3(5.f, 0.f, 5.f), tile_vertices, indices);
+		Geometry::GenerateBox(glm::vec3(-0.1f, -0.1f, -1.5f), glm::vec3(0.1f, 0.1f, 1.5f), arrow_vertices, indices);
+
+		//corners of the impostor quad, scaled to the sphere radius by the vertex shader
+		std::vector<Vertex> quad_vertices = {
+			{{-1.f, -1.f, 0.f}, {0.f, 0.f, 1.f}},
+			{{1.f, -1.f, 0.f}, {0.f, 0.f, 1.f}},
+			{{-1.f, 1.f, 0.f}, {0.f, 0.f, 1.f}},
+			{{1.f, 1.f, 0.f}, {0.f, 0.f, 1.f}}
+		};
+		std::vector<uint32_t> quad_indices = { 0, 1, 2, 2, 1, 3 };
+
+		arrow = new Mesh(arrow_vertices, indices);
+		impostor_quad = new Mesh(quad_vertices, quad_indices);
+		tile = new Mesh(tile_vertices, indices);
+		//arher is a sphere with R=1.7, drawn with fewer segments the smaller it is on screen
+		archer_lods = LodChain::GenerateSpheres(1.7f, { 32, 16, 8, 4 }, 0.5f, VertexFormat::Packed);
+		for (Mesh* level : archer_lods->meshes)
+		{
+			level->calculate_normals();
+		}
+		archer = archer_lods->Finest();
+		tile->calculate_normals();
+		simulation.SetMeshes(archer, arrow);
 	}
 
-	//projectile is shot from archer's head to the target's position
-	void ShootProjectile(entt::entity archer, glm::vec3 target)
+	void SetupField(int tilesH, int tilesV, int tileSize)
 	{
-		if (ent_registry.try_get<Archer>(archer) != nullptr)
+		for (glm::vec3 center : BattleView::FieldTiles(tilesH, tilesV, tileSize))
 		{
-			glm::vec3 pos = ent_registry.get<Position>(archer) + glm::vec3(0.f, 1.7f, 0.f);
-			entt::entity projectile = ent_registry.create();
-			Trajectory prj_trj(pos, target, 40);
-
-			float dotProdZ = glm::dot(glm::vec3(0.f, 0.f, 1.f), glm::normalize(target - pos));
-			float dotProdX = glm::dot(glm::vec3(0.f, 0.f, 1.f), glm::normalize(target - pos));
-			glm::quat q = glm::quatLookAt(glm::normalize(target - pos), glm::vec3(0.f, 1.f, 0.f));
-
-			ent_registry.emplace<Position>(projectile, glm::vec3(pos));
-			ent_registry.emplace<Orientation>(projectile, q);
-			ent_registry.emplace<Trajectory>(projectile, prj_trj);
-			ent_registry.emplace<MeshComponent>(projectile, arrow, glm::vec3(1.f), glm::vec3(0.f));
-			ent_registry.get<Archer>(archer).Reload();
+			entt::entity entity = ent_registry.create();
+			ent_registry.emplace<Position>(entity, center);
+			ent_registry.emplace<Orientation>(entity, glm::angleAxis(0.f, glm::vec3(0, 1, 0)));
+			ent_registry.emplace<MeshComponent>(entity, tile, glm::vec3(0.9f), glm::vec3(0.f, 1.f, 0.f));
+			ent_registry.emplace<StaticMesh>(entity);
 		}
 	}
 
 	GLFWwindow* window = nullptr;
-	unsigned int shaderProgram;
-	entt::registry ent_registry;
+	RenderBackend* backend = nullptr;
+	unsigned int shaderProgram = 0;
+	unsigned int impostorProgram = 0;
+	//default shaders built for PackedVertex meshes
+	unsigned int packedProgram = 0;
+	unsigned int cullProgram = 0;
+	Simulation simulation;
+	entt::registry& ent_registry = simulation.Registry();
+
+	SnapshotBuffer snapshots;
+	SimulationLoop simulation_loop{ simulation, snapshots, glfwGetTime };
+	const RenderSnapshot* drawn_snapshot = nullptr;
+	bool threaded_simulation = true;
 
-	entt::entity camera;
 	float camera_angle = 0.f;
-	const glm::vec3 camera_sp = {-80, 60, 80};
+	glm::vec3 camera_position;
+	float view_scale = 1.f;
+
+	std::string trace_path = "archers_trace.json";
+	std::string capture_target = "archers_capture.rgb";
+	FrameCapture* frame_capture = nullptr;
 
 	Mesh* tile;
 	Mesh* arrow;
 	Mesh* archer;
-	int archers_count = 0;
+	LodChain* archer_lods = nullptr;
+	Mesh* impostor_quad = nullptr;
+	StreamBuffer* stream_buffer = nullptr;
+	InstancedRenderer* renderer = nullptr;
+	ProgramCache* program_cache = nullptr;
+	FileWatcher* shader_watcher = nullptr;
+	StaticBatcher* static_batcher = nullptr;
+	bool culling = true;
+	bool lod = true;
+	bool impostors = true;
+	bool gpu_culling = false;
 };
\ No newline at end of file
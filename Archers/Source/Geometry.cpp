@@ -0,0 +1,212 @@
+#include "Geometry.h"
+
+void Geometry::GenerateSphere(float radius, int rings, int slices, std::vector<Vertex>& vertices, std::vector<uint32_t>& indices)
+{
+	vertices.clear();
+	indices.clear();
+
+	float x, y, z, xy;
+	float lengthInv = 1.0f / radius;
+
+	float sectorStep = 2 * glm::pi<double>() / rings;
+	float stackStep = glm::pi<double>() / slices;
+	float sectorAngle, stackAngle;
+
+	for (int i = 0; i <= slices; ++i)
+	{
+		stackAngle = glm::pi<double>() / 2 - i * stackStep;
+		xy = radius * glm::cos(stackAngle);
+		z = radius * glm::sin(stackAngle);
+
+		for (int j = 0; j <= rings; ++j)
+		{
+			sectorAngle = j * sectorStep;
+			x = xy * glm::cos(sectorAngle);
+			y = xy * glm::sin(sectorAngle);
+			vertices.push_back({ glm::vec3(x, y, z), glm::vec3(x * lengthInv, y * lengthInv, z * lengthInv) });
+		}
+	}
+
+	for (int i = 0; i < slices; ++i)
+	{
+		int k1 = i * (rings + 1);
+		int k2 = k1 + rings + 1;
+
+		for (int j = 0; j < rings; ++j, ++k1, ++k2)
+		{
+			if (i != 0)
+			{
+				indices.push_back(k1);
+				indices.push_back(k2);
+				indices.push_back(k1 + 1);
+			}
+			if (i != (slices - 1))
+			{
+				indices.push_back(k1 + 1);
+				indices.push_back(k2);
+				indices.push_back(k2 + 1);
+			}
+		}
+	}
+}
+
+void Geometry::GenerateBox(glm::vec3 min, glm::vec3 max, std::vector<Vertex>& vertices, std::vector<uint32_t>& indices)
+{
+	//top face first, then the bottom one with the same corners
+	vertices = {
+		{{max.x, max.y, max.z}, {1.f, 1.f, 1.f}},
+		{{max.x, max.y, min.z}, {1.f, 1.f, 1.f}},
+		{{min.x, max.y, max.z}, {1.f, 1.f, 1.f}},
+		{{min.x, max.y, min.z}, {1.f, 1.f, 1.f}},
+		{{max.x, min.y, max.z}, {1.f, 1.f, 1.f}},
+		{{max.x, min.y, min.z}, {1.f, 1.f, 1.f}},
+		{{min.x, min.y, max.z}, {1.f, 1.f, 1.f}},
+		{{min.x, min.y, min.z}, {1.f, 1.f, 1.f}}
+	};
+	indices = {
+		0, 1, 2, 2, 1, 3,
+		6, 5, 4, 7, 5, 6,
+		0, 2, 6, 6, 4, 0,
+		1, 0, 5, 4, 5, 0,
+		5, 7, 1, 3, 1, 7,
+		7, 6, 3, 2, 3, 6
+	};
+}
+
+float Geometry::SphereLodPixels(int segments, float max_error_pixels)
+{
+	float sagitta = 1.f - glm::cos(glm::pi<float>() / segments);
+	return 2.f * max_error_pixels / sagitta;
+}
+
+void Geometry::CalculateNormals(std::vector<Vertex>& verts, const std::vector<uint32_t>& inds)
+{
+	for (size_t i = 0; i < inds.size(); i += 3)
+	{
+		glm::vec3 A = verts[inds[i]].pos;
+		glm::vec3 B = verts[inds[i + 1]].pos;
+		glm::vec3 C = verts[inds[i + 2]].pos;
+
+		glm::vec3 contributingNormal = glm::cross(B - A, C - A);
+		float area = glm::length(contributingNormal) / 2.f;
+		contributingNormal = glm::normalize(contributingNormal) * area;
+
+		verts[inds[i]].normal = verts[inds[i]].normal + contributingNormal;
+		verts[inds[i + 1]].normal = verts[inds[i + 1]].normal + contributingNormal;
+		verts[inds[i + 2]].normal = verts[inds[i + 2]].normal + contributingNormal;
+	}
+
+	for (size_t i = 0; i < verts.size(); i++)
+	{
+		verts[i].normal = glm::normalize(verts[i].normal);
+	}
+}
+
+void Geometry::AppendTransformed(const Vertex* src_verts, size_t vert_count, const uint32_t* src_inds, size_t index_count, glm::vec3 position, glm::quat rotation, glm::vec3 scale,
+	std::vector<Vertex>& verts, std::vector<uint32_t>& inds)
+{
+	uint32_t base = static_cast<uint32_t>(verts.size());
+
+	for (size_t i = 0; i < vert_count; i++)
+	{
+		//normals are only rotated, the same as the instanced path does, the shader normalizes them
+		verts.push_back({ position + rotation * (scale * src_verts[i].pos), rotation * src_verts[i].normal });
+	}
+
+	for (size_t i = 0; i < index_count; i++)
+	{
+		inds.push_back(base + src_inds[i]);
+	}
+}
+
+void Geometry::BoundingSphere(const std::vector<Vertex>& verts, glm::vec3& out_center, float& out_radius)
+{
+	out_center = glm::vec3(0.f);
+	out_radius = 0.f;
+	if (verts.empty())
+		return;
+
+	glm::vec3 min_pos = verts[0].pos;
+	glm::vec3 max_pos = verts[0].pos;
+	for (const Vertex& vertex : verts)
+	{
+		min_pos = glm::min(min_pos, vertex.pos);
+		max_pos = glm::max(max_pos, vertex.pos);
+	}
+
+	out_center = 0.5f * (min_pos + max_pos);
+	float radius_sq = 0.f;
+	for (const Vertex& vertex : verts)
+	{
+		glm::vec3 diff = vertex.pos - out_center;
+		radius_sq = glm::max(radius_sq, glm::dot(diff, diff));
+	}
+	out_radius = glm::sqrt(radius_sq);
+}
+
+void Geometry::PackVertices(const std::vector<Vertex>& verts, std::vector<PackedVertex>& out_packed, glm::vec3& out_offset, glm::vec3& out_scale)
+{
+	out_packed.resize(verts.size());
+	if (verts.empty())
+	{
+		out_offset = glm::vec3(0.f);
+		out_scale = glm::vec3(1.f);
+		return;
+	}
+
+	glm::vec3 min_pos = verts[0].pos;
+	glm::vec3 max_pos = verts[0].pos;
+	for (const Vertex& vertex : verts)
+	{
+		min_pos = glm::min(min_pos, vertex.pos);
+		max_pos = glm::max(max_pos, vertex.pos);
+	}
+
+	out_offset = min_pos;
+	out_scale = max_pos - min_pos;
+	//a flat axis decodes to the offset whatever it is scaled by
+	glm::vec3 inverse_scale = glm::vec3(
+		out_scale.x > 0.f ? 1.f / out_scale.x : 0.f,
+		out_scale.y > 0.f ? 1.f / out_scale.y : 0.f,
+		out_scale.z > 0.f ? 1.f / out_scale.z : 0.f);
+
+	for (size_t i = 0; i < verts.size(); i++)
+	{
+		glm::vec3 unorm = glm::clamp((verts[i].pos - min_pos) * inverse_scale, 0.f, 1.f) * 65535.f + 0.5f;
+		glm::vec2 snorm = glm::round(glm::clamp(OctahedralEncode(verts[i].normal), -1.f, 1.f) * 32767.f);
+
+		PackedVertex& packed = out_packed[i];
+		packed.pos[0] = static_cast<uint16_t>(unorm.x);
+		packed.pos[1] = static_cast<uint16_t>(unorm.y);
+		packed.pos[2] = static_cast<uint16_t>(unorm.z);
+		packed.pos[3] = 0;
+		packed.normal[0] = static_cast<int16_t>(snorm.x);
+		packed.normal[1] = static_cast<int16_t>(snorm.y);
+	}
+}
+
+glm::vec2 Geometry::OctahedralEncode(glm::vec3 normal)
+{
+	float length = glm::abs(normal.x) + glm::abs(normal.y) + glm::abs(normal.z);
+	if (length == 0.f)
+		return glm::vec2(0.f);
+
+	glm::vec3 n = normal / length;
+	if (n.z < 0.f)
+	{
+		glm::vec2 signs = glm::vec2(n.x >= 0.f ? 1.f : -1.f, n.y >= 0.f ? 1.f : -1.f);
+		return (1.f - glm::abs(glm::vec2(n.y, n.x))) * signs;
+	}
+
+	return glm::vec2(n.x, n.y);
+}
+
+glm::vec3 Geometry::OctahedralDecode(glm::vec2 encoded)
+{
+	//same steps as octDecode in default.vert
+	glm::vec3 n = glm::vec3(encoded.x, encoded.y, 1.f - glm::abs(encoded.x) - glm::abs(encoded.y));
+	float fold = glm::max(-n.z, 0.f);
+	n.x += n.x >= 0.f ? -fold : fold;
+	n.y += n.y >= 0.f ? -fold : fold;
+	return glm::normalize(n);
+}
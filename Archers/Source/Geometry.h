@@ -0,0 +1,44 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include <glm.hpp>
+#include <gtc/constants.hpp>
+#include <gtc/quaternion.hpp>
+
+struct Vertex
+{
+	glm::vec3 pos;
+	glm::vec3 normal;
+};
+
+//half the size of Vertex, position as unorm16 within the mesh AABB (the fourth one keeps the normal aligned)
+//and the normal octahedral encoded in two snorm16
+struct PackedVertex
+{
+	uint16_t pos[4];
+	int16_t normal[2];
+};
+
+//CPU side mesh generation and processing, nothing here touches GL
+class Geometry
+{
+public:
+	static void GenerateSphere(float radius, int rings, int slices, std::vector<Vertex>& vertices, std::vector<uint32_t>& indices);
+	//box between two corners with normals of (1, 1, 1), the field tiles and arrows, CalculateNormals gives them real ones
+	static void GenerateBox(glm::vec3 min, glm::vec3 max, std::vector<Vertex>& vertices, std::vector<uint32_t>& indices);
+	//a circle of n segments falls short of the true one by r * (1 - cos(pi / n)), this is the diameter in pixels
+	//below which that gap is under max_error_pixels
+	static float SphereLodPixels(int segments, float max_error_pixels);
+	//area weighted face normals are added to the existing vertex normals, then normalized
+	static void CalculateNormals(std::vector<Vertex>& verts, const std::vector<uint32_t>& inds);
+	//appends the mesh moved to its place in the world, indices are rebased onto the vertices already there
+	static void AppendTransformed(const Vertex* src_verts, size_t vert_count, const uint32_t* src_inds, size_t index_count, glm::vec3 position, glm::quat rotation, glm::vec3 scale,
+		std::vector<Vertex>& verts, std::vector<uint32_t>& inds);
+	//sphere around the vertex AABB center, within a few percent of the tightest sphere for the meshes we have
+	static void BoundingSphere(const std::vector<Vertex>& verts, glm::vec3& out_center, float& out_radius);
+	//packed positions decode as out_offset + out_scale * unorm, every axis of the AABB uses the full 16 bits
+	static void PackVertices(const std::vector<Vertex>& verts, std::vector<PackedVertex>& out_packed, glm::vec3& out_offset, glm::vec3& out_scale);
+	//unit vector onto the [-1, 1] square, the lower half of the octahedron folded over the diagonals
+	static glm::vec2 OctahedralEncode(glm::vec3 normal);
+	static glm::vec3 OctahedralDecode(glm::vec2 encoded);
+};
@@ -0,0 +1,265 @@
+#include "GeometryArena.h"
+#include <algorithm>
+#include <cstring>
+#include "Hash.h"
+
+//enough for the archer spheres, arrow and tiles, static batches grow it
+static const uint32_t initial_vertices = 1 << 16;
+static const uint32_t initial_indices = 1 << 18;
+
+static GeometryArena* arena = nullptr;
+
+uint32_t RangeAllocator::Allocate(uint32_t count)
+{
+	for (auto block = free_blocks.begin(); block != free_blocks.end(); ++block)
+	{
+		if (block->second < count)
+			continue;
+
+		uint32_t first = block->first;
+		uint32_t remaining = block->second - count;
+		free_blocks.erase(block);
+		if (remaining > 0)
+			free_blocks[first + count] = remaining;
+
+		used += count;
+		return first;
+	}
+
+	return npos;
+}
+
+void RangeAllocator::Free(uint32_t first, uint32_t count)
+{
+	if (count == 0)
+		return;
+
+	used -= count;
+	auto next = free_blocks.lower_bound(first);
+
+	//merged into the block ending where this one starts
+	if (next != free_blocks.begin())
+	{
+		auto previous = std::prev(next);
+		if (previous->first + previous->second == first)
+		{
+			first = previous->first;
+			count += previous->second;
+			free_blocks.erase(previous);
+		}
+	}
+
+	//and with the block starting where it ends
+	if (next != free_blocks.end() && first + count == next->first)
+	{
+		count += next->second;
+		free_blocks.erase(next);
+	}
+
+	free_blocks[first] = count;
+}
+
+void RangeAllocator::Grow(uint32_t new_capacity)
+{
+	if (new_capacity <= capacity)
+		return;
+
+	uint32_t added = new_capacity - capacity;
+	uint32_t first = capacity;
+	capacity = new_capacity;
+
+	//Free counts the new space as released, it was never used
+	used += added;
+	Free(first, added);
+}
+
+void GeometryArena::Create(RenderBackend& backend)
+{
+	if (arena == nullptr)
+		arena = new GeometryArena(backend);
+}
+
+GeometryArena& GeometryArena::Get()
+{
+	return *arena;
+}
+
+void GeometryArena::Destroy()
+{
+	delete arena;
+	arena = nullptr;
+}
+
+GeometryArena::GeometryArena(RenderBackend& arena_backend) : backend(arena_backend)
+{
+	index_buffer = backend.CreateBuffer(initial_indices * sizeof(uint32_t));
+	index_ranges.Grow(initial_indices);
+	index_shadow.resize(initial_indices);
+
+	CreateVertexPool(VertexFormat::Float, sizeof(Vertex), initial_vertices);
+	CreateVertexPool(VertexFormat::Packed, sizeof(PackedVertex), initial_vertices);
+}
+
+GeometryArena::~GeometryArena()
+{
+	for (VertexPool& pool : pools)
+	{
+		backend.DeleteBuffer(pool.buffer);
+		backend.DeleteVertexArray(pool.vertex_array);
+	}
+	backend.DeleteBuffer(index_buffer);
+}
+
+//the vertex layout is recorded into the vertex array once, drawing only binds it and the instance range
+void GeometryArena::CreateVertexPool(VertexFormat format, size_t stride, uint32_t capacity)
+{
+	VertexPool& pool = pools[static_cast<int>(format)];
+	pool.stride = stride;
+	pool.ranges.Grow(capacity);
+
+	pool.buffer = backend.CreateBuffer(capacity * stride);
+	pool.vertex_array = backend.CreateVertexArray(format, pool.buffer, stride, index_buffer);
+}
+
+uint32_t GeometryArena::AllocateVertices(VertexFormat format, uint32_t count)
+{
+	if (count == 0)
+		return 0;
+
+	VertexPool& pool = pools[static_cast<int>(format)];
+	uint32_t first = pool.ranges.Allocate(count);
+	if (first == RangeAllocator::npos)
+	{
+		GrowVertices(pool, count);
+		first = pool.ranges.Allocate(count);
+	}
+
+	return first;
+}
+
+void GeometryArena::WriteVertices(VertexFormat format, uint32_t base_vertex, const void* data, uint32_t count)
+{
+	VertexPool& pool = pools[static_cast<int>(format)];
+	backend.UploadBuffer(pool.buffer, base_vertex * pool.stride, data, count * pool.stride);
+}
+
+void GeometryArena::FreeVertices(VertexFormat format, uint32_t base_vertex, uint32_t count)
+{
+	pools[static_cast<int>(format)].ranges.Free(base_vertex, count);
+}
+
+uint32_t GeometryArena::AllocateIndices(const uint32_t* indices, uint32_t count)
+{
+	if (count == 0)
+		return 0;
+
+	//indices are relative to the base vertex, so meshes built from the same index list share one copy
+	uint64_t hash = HashIndices(indices, count);
+	auto range = index_blocks.equal_range(hash);
+	for (auto block = range.first; block != range.second; ++block)
+	{
+		if (block->second.count == count && memcmp(&index_shadow[block->second.first], indices, count * sizeof(uint32_t)) == 0)
+		{
+			block->second.references++;
+			return block->second.first;
+		}
+	}
+
+	uint32_t first = index_ranges.Allocate(count);
+	if (first == RangeAllocator::npos)
+	{
+		GrowIndices(count);
+		first = index_ranges.Allocate(count);
+	}
+
+	std::copy(indices, indices + count, index_shadow.begin() + first);
+	backend.UploadBuffer(index_buffer, first * sizeof(uint32_t), indices, count * sizeof(uint32_t));
+	index_blocks.insert({ hash, { first, count, 1 } });
+
+	return first;
+}
+
+void GeometryArena::FreeIndices(uint32_t first_index, uint32_t count)
+{
+	if (count == 0)
+		return;
+
+	auto range = index_blocks.equal_range(HashIndices(&index_shadow[first_index], count));
+	for (auto block = range.first; block != range.second; ++block)
+	{
+		if (block->second.first != first_index || block->second.count != count)
+			continue;
+
+		if (--block->second.references == 0)
+		{
+			index_ranges.Free(first_index, count);
+			index_blocks.erase(block);
+		}
+		return;
+	}
+}
+
+//contents are copied on the GPU into a buffer twice as large, meshes keep their offsets
+void GeometryArena::GrowVertices(VertexPool& pool, uint32_t count)
+{
+	uint32_t old_capacity = pool.ranges.Capacity();
+	uint32_t new_capacity = std::max(old_capacity * 2, old_capacity + count);
+
+	uint32_t buffer = backend.CreateBuffer(new_capacity * pool.stride);
+	backend.CopyBuffer(pool.buffer, buffer, old_capacity * pool.stride);
+	backend.DeleteBuffer(pool.buffer);
+
+	pool.buffer = buffer;
+	pool.ranges.Grow(new_capacity);
+	backend.SetVertexArrayBuffers(pool.vertex_array, pool.buffer, pool.stride, index_buffer);
+	vertex_grows++;
+}
+
+void GeometryArena::GrowIndices(uint32_t count)
+{
+	uint32_t old_capacity = index_ranges.Capacity();
+	uint32_t new_capacity = std::max(old_capacity * 2, old_capacity + count);
+
+	uint32_t buffer = backend.CreateBuffer(new_capacity * sizeof(uint32_t));
+	backend.CopyBuffer(index_buffer, buffer, old_capacity * sizeof(uint32_t));
+	backend.DeleteBuffer(index_buffer);
+
+	index_buffer = buffer;
+	index_ranges.Grow(new_capacity);
+	index_shadow.resize(new_capacity);
+	for (VertexPool& pool : pools)
+	{
+		backend.SetVertexArrayBuffers(pool.vertex_array, pool.buffer, pool.stride, index_buffer);
+	}
+	index_grows++;
+}
+
+uint64_t GeometryArena::HashIndices(const uint32_t* indices, uint32_t count)
+{
+	return Fnv1a(indices, count * sizeof(uint32_t));
+}
+
+ArenaStats GeometryArena::Stats() const
+{
+	ArenaStats stats;
+	for (const VertexPool& pool : pools)
+	{
+		stats.vertex_bytes += pool.ranges.Used() * pool.stride;
+		stats.vertex_capacity_bytes += pool.ranges.Capacity() * pool.stride;
+	}
+
+	stats.index_bytes = index_ranges.Used() * sizeof(uint32_t);
+	stats.index_capacity_bytes = index_ranges.Capacity() * sizeof(uint32_t);
+	stats.vertex_grows = vertex_grows;
+	stats.index_grows = index_grows;
+	for (const auto& block : index_blocks)
+	{
+		if (block.second.references > 1)
+		{
+			stats.shared_index_ranges++;
+			stats.shared_index_bytes += (block.second.references - 1) * block.second.count * sizeof(uint32_t);
+		}
+	}
+
+	return stats;
+}
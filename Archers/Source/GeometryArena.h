@@ -0,0 +1,114 @@
+#pragma once
+#include <map>
+#include <unordered_map>
+#include "RenderBackend.h"
+
+//first fit over a range of elements, freed neighbours are merged back into one block
+class RangeAllocator
+{
+public:
+	//first element of the range or npos when no free block is large enough
+	uint32_t Allocate(uint32_t count);
+	void Free(uint32_t first, uint32_t count);
+	//the range grows at its end, allocated ranges keep their place
+	void Grow(uint32_t new_capacity);
+
+	uint32_t Capacity() const
+	{
+		return capacity;
+	}
+
+	uint32_t Used() const
+	{
+		return used;
+	}
+
+	static const uint32_t npos = 0xFFFFFFFF;
+
+private:
+	//free blocks by first element
+	std::map<uint32_t, uint32_t> free_blocks;
+	uint32_t capacity = 0;
+	uint32_t used = 0;
+};
+
+struct ArenaStats
+{
+	size_t vertex_bytes = 0;
+	size_t vertex_capacity_bytes = 0;
+	size_t index_bytes = 0;
+	size_t index_capacity_bytes = 0;
+	//index ranges handed to more than one mesh, and the bytes not uploaded because of it
+	size_t shared_index_ranges = 0;
+	size_t shared_index_bytes = 0;
+	//times a full buffer was doubled since the arena was created
+	size_t vertex_grows = 0;
+	size_t index_grows = 0;
+};
+
+//every mesh's vertices and indices live in a few large buffers, one vertex buffer and one vertex array per
+//vertex format and one index buffer for all of them, so meshes of a format are drawn without rebinding anything
+class GeometryArena
+{
+public:
+	//before the first mesh, the buffers are made by the backend
+	static void Create(RenderBackend& backend);
+	static GeometryArena& Get();
+	//deletes the buffers, every mesh has to be gone and the backend still alive
+	static void Destroy();
+
+	GeometryArena(const GeometryArena&) = delete;
+	GeometryArena& operator=(const GeometryArena&) = delete;
+
+	//base vertex of count vertices of the format, the buffer grows when full
+	uint32_t AllocateVertices(VertexFormat format, uint32_t count);
+	void WriteVertices(VertexFormat format, uint32_t base_vertex, const void* data, uint32_t count);
+	void FreeVertices(VertexFormat format, uint32_t base_vertex, uint32_t count);
+
+	//first index of a copy of the indices, a list already in the arena is shared instead of uploaded again
+	uint32_t AllocateIndices(const uint32_t* indices, uint32_t count);
+	void FreeIndices(uint32_t first_index, uint32_t count);
+
+	//vertex attributes of the format with the index buffer attached, instance data goes to binding 1
+	uint32_t VertexArray(VertexFormat format) const
+	{
+		return pools[static_cast<int>(format)].vertex_array;
+	}
+
+	ArenaStats Stats() const;
+
+private:
+	struct VertexPool
+	{
+		uint32_t buffer = 0;
+		uint32_t vertex_array = 0;
+		size_t stride = 0;
+		RangeAllocator ranges;
+	};
+
+	//one upload of an index list and the meshes using it
+	struct IndexBlock
+	{
+		uint32_t first;
+		uint32_t count;
+		uint32_t references;
+	};
+
+	GeometryArena(RenderBackend& arena_backend);
+	~GeometryArena();
+
+	void CreateVertexPool(VertexFormat format, size_t stride, uint32_t capacity);
+	void GrowVertices(VertexPool& pool, uint32_t count);
+	void GrowIndices(uint32_t count);
+	static uint64_t HashIndices(const uint32_t* indices, uint32_t count);
+
+	RenderBackend& backend;
+	VertexPool pools[2];
+	uint32_t index_buffer = 0;
+	RangeAllocator index_ranges;
+	//CPU copy of the index buffer, incoming lists are compared against it
+	std::vector<uint32_t> index_shadow;
+	std::unordered_multimap<uint64_t, IndexBlock> index_blocks;
+	size_t vertex_grows = 0;
+	size_t index_grows = 0;
+};
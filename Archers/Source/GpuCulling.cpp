@@ -0,0 +1,72 @@
+#include "GpuCulling.h"
+#include "Profiler.h"
+
+//floats per InstanceData, matches instanceFloats in cull.comp
+static const size_t instance_floats = 13;
+static const uint32_t group_size = 64;
+
+GpuCuller::~GpuCuller()
+{
+	for (uint32_t buffer : { command_buffer, instance_buffer, visible_buffer })
+	{
+		if (buffer != 0)
+			backend.DeleteBuffer(buffer);
+	}
+}
+
+//written by the GPU every frame and read by the draws, never mapped, grown by half again to avoid regrowing each frame
+void GpuCuller::Reserve(uint32_t& buffer, size_t& capacity, size_t bytes)
+{
+	if (bytes <= capacity)
+		return;
+
+	capacity = bytes + bytes / 2;
+	if (buffer != 0)
+		backend.DeleteBuffer(buffer);
+	buffer = backend.CreateBuffer(capacity, true);
+}
+
+void GpuCuller::Cull(GLStateCache& state, const Frustum& frustum, bool culling, const StreamAllocation& instances, const StreamAllocation& spheres,
+	const StreamAllocation& draw_ids, size_t instance_count, const std::vector<DrawElementsIndirectCommand>& commands)
+{
+	PROFILE_ZONE("GpuCull");
+
+	size_t command_bytes = commands.size() * sizeof(DrawElementsIndirectCommand);
+	size_t instance_bytes = instance_count * instance_floats * sizeof(float);
+	Reserve(command_buffer, command_capacity, command_bytes);
+	Reserve(instance_buffer, instance_capacity, instance_bytes);
+	Reserve(visible_buffer, visible_capacity, instance_count * sizeof(uint32_t));
+
+	//instance counts start at 0 and are counted up by the shader
+	backend.UploadBuffer(command_buffer, 0, commands.data(), command_bytes);
+
+	state.UseProgram(program);
+	backend.SetUniformVec4(program, 0, frustum.planes, 6);
+	backend.SetUniformUint(program, 6, static_cast<uint32_t>(instance_count));
+	backend.SetUniformInt(program, 7, culling ? 1 : 0);
+
+	backend.BindStorageRange(0, instances.buffer, instances.offset, instance_bytes);
+	backend.BindStorageRange(1, spheres.buffer, spheres.offset, instance_count * sizeof(glm::vec4));
+	backend.BindStorageRange(2, draw_ids.buffer, draw_ids.offset, instance_count * sizeof(uint32_t));
+	backend.BindStorageRange(3, command_buffer, 0, command_bytes);
+	backend.BindStorageRange(4, instance_buffer, 0, instance_bytes);
+	backend.BindStorageRange(5, visible_buffer, 0, instance_count * sizeof(uint32_t));
+
+	backend.DispatchCompute(static_cast<uint32_t>((instance_count + group_size - 1) / group_size));
+	//the draws read the counts as commands and the packed instances as attributes
+	backend.ComputeBarrier();
+
+	last_commands = commands.size();
+	last_instances = instance_count;
+}
+
+void GpuCuller::ReadBack(std::vector<DrawElementsIndirectCommand>& out_commands, std::vector<uint32_t>& out_visible) const
+{
+	out_commands.resize(last_commands);
+	out_visible.resize(last_instances);
+	if (last_commands == 0)
+		return;
+
+	backend.ReadBuffer(command_buffer, 0, out_commands.data(), last_commands * sizeof(DrawElementsIndirectCommand));
+	backend.ReadBuffer(visible_buffer, 0, out_visible.data(), last_instances * sizeof(uint32_t));
+}
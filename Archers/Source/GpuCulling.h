@@ -0,0 +1,73 @@
+#pragma once
+#include "Culling.h"
+#include "StreamBuffer.h"
+#include "RenderQueue.h"
+
+//a GPU culled frame compared with FrustumCuller
+struct GpuCullCheck
+{
+	size_t draws = 0;
+	//draws whose visible instances differ from the CPU's
+	size_t mismatched_draws = 0;
+	size_t visible = 0;
+	size_t triangles = 0;
+};
+
+//frustum culls instances in Shaders/cull.comp, the instances of a command are read from its range of the input
+//starting at base_instance and the visible ones are packed into the same range of the output, counted by its instance_count
+class GpuCuller
+{
+public:
+	GpuCuller(RenderBackend& culler_backend) : backend(culler_backend)
+	{
+	}
+	~GpuCuller();
+
+	GpuCuller(const GpuCuller&) = delete;
+	GpuCuller& operator=(const GpuCuller&) = delete;
+
+	//0 until the compute program is loaded, the renderer culls on the CPU meanwhile
+	void SetProgram(uint32_t compute_program)
+	{
+		program = compute_program;
+	}
+
+	bool Available() const
+	{
+		return program != 0;
+	}
+
+	//instances holds instance_count InstanceData, spheres a center and radius vec4 and draw_ids the command of each
+	//instance, all of them aligned for shader storage, everything is visible while culling is false
+	void Cull(GLStateCache& state, const Frustum& frustum, bool culling, const StreamAllocation& instances, const StreamAllocation& spheres,
+		const StreamAllocation& draw_ids, size_t instance_count, const std::vector<DrawElementsIndirectCommand>& commands);
+
+	//commands with their visible counts, for RenderBackend::MultiDrawIndirect
+	uint32_t CommandBuffer() const
+	{
+		return command_buffer;
+	}
+
+	//visible instances, read through vertex buffer binding 1 from offset 0
+	uint32_t InstanceBuffer() const
+	{
+		return instance_buffer;
+	}
+
+	//waits for the last Cull, out_visible holds the index within its command's range of every visible instance
+	void ReadBack(std::vector<DrawElementsIndirectCommand>& out_commands, std::vector<uint32_t>& out_visible) const;
+
+private:
+	void Reserve(uint32_t& buffer, size_t& capacity, size_t bytes);
+
+	RenderBackend& backend;
+	uint32_t program = 0;
+	uint32_t command_buffer = 0;
+	uint32_t instance_buffer = 0;
+	uint32_t visible_buffer = 0;
+	size_t command_capacity = 0;
+	size_t instance_capacity = 0;
+	size_t visible_capacity = 0;
+	size_t last_commands = 0;
+	size_t last_instances = 0;
+};
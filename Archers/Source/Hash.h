@@ -0,0 +1,19 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+//offset basis of 64 bit FNV-1a, the seed of a hash nothing has been added to yet
+const uint64_t fnv1a_basis = 0xcbf29ce484222325ull;
+
+//64 bit FNV-1a over size bytes, pass the previous result as seed to hash several pieces as one
+inline uint64_t Fnv1a(const void* data, size_t size, uint64_t seed = fnv1a_basis)
+{
+	uint64_t hash = seed;
+	const uint8_t* bytes = static_cast<const uint8_t*>(data);
+	for (size_t i = 0; i < size; i++)
+	{
+		hash = (hash ^ bytes[i]) * 0x100000001b3ull;
+	}
+
+	return hash;
+}
@@ -0,0 +1,104 @@
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include "Simulation.h"
+#include "Profiler.h"
+#include "BattleView.h"
+
+//runs a battle without a window or GL context as fast as the CPU allows
+
+static void PrintUsage(const char* program)
+{
+	printf("usage: %s [--archers N] [--ticks N] [--seed N] [--tick-rate HZ] [--trace FILE] [--render FILE.ppm] [--size WxH] [--threads N]\n", program);
+}
+
+int main(int argc, char* argv[])
+{
+	int archer_count = 40;
+	uint32_t seed = 0;
+	long ticks = 2000;
+	double tick_rate = 20.0;
+	const char* trace_path = nullptr;
+	//the last tick drawn by the software rasterizer, framed as the game frames it
+	const char* render_path = nullptr;
+	int render_width = 1280;
+	int render_height = 720;
+	int render_threads = 0;
+
+	for (int i = 1; i < argc; i++)
+	{
+		if (i + 1 < argc && strcmp(argv[i], "--archers") == 0)
+			archer_count = atoi(argv[++i]);
+		else if (i + 1 < argc && strcmp(argv[i], "--ticks") == 0)
+			ticks = atol(argv[++i]);
+		else if (i + 1 < argc && strcmp(argv[i], "--seed") == 0)
+			seed = static_cast<uint32_t>(strtoul(argv[++i], nullptr, 10));
+		else if (i + 1 < argc && strcmp(argv[i], "--tick-rate") == 0)
+			tick_rate = atof(argv[++i]);
+		else if (i + 1 < argc && strcmp(argv[i], "--trace") == 0)
+			trace_path = argv[++i];
+		else if (i + 1 < argc && strcmp(argv[i], "--render") == 0)
+			render_path = argv[++i];
+		else if (i + 1 < argc && strcmp(argv[i], "--size") == 0 && sscanf(argv[i + 1], "%dx%d", &render_width, &render_height) == 2)
+			i++;
+		else if (i + 1 < argc && strcmp(argv[i], "--threads") == 0)
+			render_threads = atoi(argv[++i]);
+		else
+		{
+			PrintUsage(argv[0]);
+			return -1;
+		}
+	}
+
+	if (archer_count < 2 || ticks < 1 || tick_rate <= 0.0 || render_width < 1 || render_height < 1)
+	{
+		PrintUsage(argv[0]);
+		return -1;
+	}
+
+	SimulationSettings settings = SimulationSettings::Scaled(archer_count, seed);
+
+	Simulation simulation(settings);
+	simulation.Clock().SetTickRate(tick_rate);
+
+	if (trace_path != nullptr)
+	{
+		Profiler::SetThreadName("Simulation");
+		Profiler::SetEnabled(true);
+	}
+
+	auto start = std::chrono::steady_clock::now();
+	for (long tick = 0; tick < ticks; tick++)
+	{
+		simulation.Step();
+	}
+	double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	printf("archers: %d, ticks: %ld, seed: %u\n", settings.archer_count, ticks, settings.seed);
+	printf("%.3f s, %.1f ticks/sec, %.1fx real time\n", seconds, ticks / seconds, simulation.Clock().Now() / seconds);
+	printf("left: %d red, %d blue, %zu arrows in flight\n", simulation.ArchersLeft(true), simulation.ArchersLeft(false), simulation.Registry().view<Trajectory>().size());
+	printf("state hash: %016llx\n", static_cast<unsigned long long>(simulation.StateHash()));
+
+	if (render_path != nullptr)
+	{
+		BattleView view;
+		SoftwareRasterizer rasterizer(render_width, render_height, render_threads);
+		view.Render(simulation, rasterizer);
+		const RasterStats& raster = rasterizer.Stats();
+		printf("rendered %dx%d in %.2f ms (setup %.2f ms, raster %.2f ms), %zu triangles, %d threads, %d pixels per test\n", render_width,
+			render_height, (raster.setup_seconds + raster.raster_seconds) * 1e3, raster.setup_seconds * 1e3, raster.raster_seconds * 1e3,
+			raster.triangles, rasterizer.Threads(), SoftwareRasterizer::Lanes());
+
+		if (rasterizer.WritePPM(render_path) == false)
+		{
+			printf("couldn't write %s\n", render_path);
+			return -1;
+		}
+	}
+
+	if (trace_path != nullptr && Profiler::WriteTrace(trace_path) == false)
+		return -1;
+
+	return 0;
+}
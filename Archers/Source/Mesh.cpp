@@ -0,0 +1,127 @@
+#include "Mesh.h"
+#include "GeometryArena.h"
+#include <cfloat>
+
+static uint32_t next_mesh_id = 1;
+
+Mesh::Mesh(std::vector<Vertex> vertices, std::vector<uint32_t> indices, VertexFormat vertex_format)
+{
+	format = vertex_format;
+	verts.resize(vertices.size());
+	inds.resize(indices.size());
+	std::copy(vertices.begin(), vertices.end(), verts.begin());
+	std::copy(indices.begin(), indices.end(), inds.begin());
+	Geometry::BoundingSphere(verts, bounds_center, bounds_radius);
+
+	CreateBuffers();
+}
+
+Mesh::Mesh(const Mesh& other)
+{
+	verts.resize(other.verts.size());
+	inds.resize(other.inds.size());
+	std::copy(other.verts.begin(), other.verts.end(), verts.begin());
+	std::copy(other.inds.begin(), other.inds.end(), inds.begin());
+	bounds_center = other.bounds_center;
+	bounds_radius = other.bounds_radius;
+	format = other.format;
+
+	CreateBuffers();
+}
+
+void Mesh::calculate_normals()
+{
+	Geometry::CalculateNormals(verts, inds);
+
+	UploadVertices();
+}
+
+Mesh::~Mesh()
+{
+	//a default constructed mesh never touched the arena
+	if (id == 0)
+		return;
+
+	GeometryArena& arena = GeometryArena::Get();
+	arena.FreeVertices(format, base_vertex, static_cast<uint32_t>(verts.size()));
+	arena.FreeIndices(first_index, static_cast<uint32_t>(inds.size()));
+}
+
+uint32_t Mesh::VertexArray() const
+{
+	return GeometryArena::Get().VertexArray(format);
+}
+
+void Mesh::CreateBuffers()
+{
+	id = next_mesh_id++;
+
+	GeometryArena& arena = GeometryArena::Get();
+	base_vertex = arena.AllocateVertices(format, static_cast<uint32_t>(verts.size()));
+	first_index = arena.AllocateIndices(inds.data(), static_cast<uint32_t>(inds.size()));
+	UploadVertices();
+}
+
+void Mesh::UploadVertices()
+{
+	GeometryArena& arena = GeometryArena::Get();
+	if (format == VertexFormat::Packed)
+	{
+		std::vector<PackedVertex> packed;
+		Geometry::PackVertices(verts, packed, pack_offset, pack_scale);
+		arena.WriteVertices(format, base_vertex, packed.data(), static_cast<uint32_t>(packed.size()));
+	}
+	else
+	{
+		arena.WriteVertices(format, base_vertex, verts.data(), static_cast<uint32_t>(verts.size()));
+	}
+}
+
+LodChain::~LodChain()
+{
+	for (Mesh* mesh : meshes)
+	{
+		delete mesh;
+	}
+}
+
+int LodChain::Select(float pixels, int previous) const
+{
+	int level = 0;
+	while (level + 1 < Levels() && pixels < min_pixels[level])
+	{
+		level++;
+	}
+
+	if (previous >= 0 && previous < Levels() && previous != level)
+	{
+		//the previous level is kept until the size is past its band by the hysteresis margin
+		float lower = min_pixels[previous] * (1.f - hysteresis);
+		float upper = previous > 0 ? min_pixels[previous - 1] * (1.f + hysteresis) : FLT_MAX;
+		if (pixels >= lower && pixels < upper)
+			level = previous;
+	}
+
+	return level;
+}
+
+LodChain* LodChain::GenerateSpheres(float radius, const std::vector<int>& segments, float max_error_pixels, VertexFormat format)
+{
+	LodChain* chain = new LodChain();
+
+	for (size_t i = 0; i < segments.size(); i++)
+	{
+		std::vector<Vertex> vertices;
+		std::vector<uint32_t> indices;
+		Geometry::GenerateSphere(radius, segments[i], segments[i], vertices, indices);
+		chain->meshes.push_back(new Mesh(vertices, indices, format));
+
+		//the previous level is needed once this one's silhouette is max_error_pixels off
+		if (i > 0)
+			chain->min_pixels.push_back(Geometry::SphereLodPixels(segments[i], max_error_pixels));
+	}
+	chain->min_pixels.push_back(0.f);
+
+	chain->meshes.front()->SetLods(chain);
+	return chain;
+}
\ No newline at end of file
@@ -0,0 +1,158 @@
+#pragma once
+#include "Geometry.h"
+
+struct LodChain;
+
+//layout of the vertices on the GPU, the CPU copy is always Vertex
+enum class VertexFormat
+{
+	//24 bytes, float position and normal
+	Float,
+	//12 bytes, PackedVertex, drawn with the PACKED_VERTEX variant of the shaders
+	Packed
+};
+
+//vertices and indices kept on the CPU and uploaded to ranges of the GeometryArena, which has to exist before the first mesh
+struct Mesh
+{
+	Mesh() = default;
+	Mesh(std::vector<Vertex> vertices, std::vector<uint32_t> indices, VertexFormat vertex_format = VertexFormat::Float);
+	Mesh(const Mesh& other);
+	~Mesh();
+
+	size_t NumVerts()
+	{
+		return verts.size();
+	}
+
+	size_t NumIndices()
+	{
+		return inds.size();
+	}
+
+	const Vertex* Vertices()
+	{
+		return verts.data();
+	}
+
+	const uint32_t* Indices()
+	{
+		return inds.data();
+	}
+
+	//bounding sphere in model space, computed when the mesh is created
+	glm::vec3 BoundsCenter() const
+	{
+		return bounds_center;
+	}
+
+	float BoundsRadius() const
+	{
+		return bounds_radius;
+	}
+
+	//the vertices and indices are ranges of the GeometryArena, every mesh of a format shares its VAO,
+	//instance data is read through vertex buffer binding 1
+	uint32_t VertexArray() const;
+
+	uint32_t BaseVertex() const
+	{
+		return base_vertex;
+	}
+
+	uint32_t FirstIndex() const
+	{
+		return first_index;
+	}
+
+	VertexFormat Format() const
+	{
+		return format;
+	}
+
+	//packed positions decode as PackOffset() + PackScale() * unorm, the renderer folds this into the instance transform
+	glm::vec3 PackOffset() const
+	{
+		return pack_offset;
+	}
+
+	glm::vec3 PackScale() const
+	{
+		return pack_scale;
+	}
+
+	//size of the mesh's vertex range
+	size_t VertexBytes() const
+	{
+		return verts.size() * (format == VertexFormat::Packed ? sizeof(PackedVertex) : sizeof(Vertex));
+	}
+
+	//unique for the lifetime of the program, used to sort draws
+	uint32_t Id() const
+	{
+		return id;
+	}
+
+	//coarser versions the renderer may draw instead, null for meshes drawn as they are
+	const LodChain* Lods() const
+	{
+		return lods;
+	}
+
+	void SetLods(const LodChain* chain)
+	{
+		lods = chain;
+	}
+
+	void calculate_normals();
+
+private:
+	void CreateBuffers();
+	//vertex range contents in the mesh's format
+	void UploadVertices();
+
+	std::vector<Vertex> verts;
+	std::vector<uint32_t> inds;
+	uint32_t base_vertex = 0;
+	uint32_t first_index = 0;
+	uint32_t id = 0;
+	glm::vec3 bounds_center = glm::vec3(0.f);
+	float bounds_radius = 0.f;
+	const LodChain* lods = nullptr;
+	VertexFormat format = VertexFormat::Float;
+	glm::vec3 pack_offset = glm::vec3(0.f);
+	glm::vec3 pack_scale = glm::vec3(1.f);
+};
+
+//versions of one mesh from the finest to the coarsest, each used down to a projected diameter in pixels,
+//the chain owns its meshes and the finest one links back to it
+struct LodChain
+{
+	LodChain() = default;
+	LodChain(const LodChain&) = delete;
+	LodChain& operator=(const LodChain&) = delete;
+	~LodChain();
+
+	std::vector<Mesh*> meshes;
+	//level i is drawn at min_pixels[i] and above, the coarsest one has 0
+	std::vector<float> min_pixels;
+	//fraction of a threshold the size has to move past it before the previous level is left, stops flickering
+	float hysteresis = 0.1f;
+
+	Mesh* Finest() const
+	{
+		return meshes.front();
+	}
+
+	int Levels() const
+	{
+		return static_cast<int>(meshes.size());
+	}
+
+	//level for an object of the given projected diameter, previous is its level last frame or -1
+	int Select(float pixels, int previous) const;
+
+	//spheres of the given segment counts, finest first, each switched to the next once the silhouette of the
+	//coarser one is within max_error_pixels of the true circle
+	static LodChain* GenerateSpheres(float radius, const std::vector<int>& segments, float max_error_pixels = 0.5f, VertexFormat format = VertexFormat::Float);
+};
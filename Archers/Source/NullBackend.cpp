@@ -0,0 +1,149 @@
+#include "NullBackend.h"
+#include <cstring>
+
+//any non-null pointer does, nothing ever waits on it
+static int signaled_fence = 0;
+
+uint32_t NullBackend::CreateBuffer(size_t /*bytes*/, bool /*gpu_written*/)
+{
+	live_objects++;
+	return next_name++;
+}
+
+uint32_t NullBackend::CreateMappedBuffer(size_t bytes, void** out_mapped)
+{
+	uint32_t buffer = CreateBuffer(bytes);
+	std::vector<uint8_t>& storage = mapped[buffer];
+	storage.resize(bytes);
+	*out_mapped = storage.data();
+	return buffer;
+}
+
+uint32_t NullBackend::CreateReadbackBuffer(size_t bytes, void** out_mapped)
+{
+	return CreateMappedBuffer(bytes, out_mapped);
+}
+
+void NullBackend::UploadBuffer(uint32_t /*buffer*/, size_t /*offset*/, const void* /*data*/, size_t bytes)
+{
+	counters.bytes_uploaded += bytes;
+}
+
+void NullBackend::CopyBuffer(uint32_t /*source*/, uint32_t /*destination*/, size_t /*bytes*/)
+{
+}
+
+void NullBackend::ReadBuffer(uint32_t /*buffer*/, size_t /*offset*/, void* data, size_t bytes)
+{
+	memset(data, 0, bytes);
+}
+
+void NullBackend::DeleteBuffer(uint32_t buffer)
+{
+	mapped.erase(buffer);
+	live_objects--;
+}
+
+uint32_t NullBackend::CreateVertexArray(VertexFormat /*format*/, uint32_t /*vertex_buffer*/, size_t /*stride*/, uint32_t /*index_buffer*/)
+{
+	live_objects++;
+	return next_name++;
+}
+
+void NullBackend::SetVertexArrayBuffers(uint32_t /*vertex_array*/, uint32_t /*vertex_buffer*/, size_t /*stride*/, uint32_t /*index_buffer*/)
+{
+}
+
+void NullBackend::DeleteVertexArray(uint32_t /*vertex_array*/)
+{
+	live_objects--;
+}
+
+void NullBackend::DeleteProgram(uint32_t /*program*/)
+{
+}
+
+void NullBackend::SetUniformVec4(uint32_t /*program*/, int /*location*/, const glm::vec4* /*values*/, int /*count*/)
+{
+}
+
+void NullBackend::SetUniformInt(uint32_t /*program*/, int /*location*/, int32_t /*value*/)
+{
+}
+
+void NullBackend::SetUniformUint(uint32_t /*program*/, int /*location*/, uint32_t /*value*/)
+{
+}
+
+void NullBackend::UseProgram(uint32_t /*program*/)
+{
+	counters.state_changes++;
+}
+
+void NullBackend::BindVertexArray(uint32_t /*vertex_array*/)
+{
+	counters.state_changes++;
+}
+
+void NullBackend::BindVertexBuffer(uint32_t /*binding*/, uint32_t /*buffer*/, size_t /*offset*/, size_t /*stride*/)
+{
+	counters.state_changes++;
+}
+
+void NullBackend::BindUniformRange(uint32_t /*index*/, uint32_t /*buffer*/, size_t /*offset*/, size_t /*bytes*/)
+{
+	counters.state_changes++;
+}
+
+void NullBackend::BindStorageRange(uint32_t /*index*/, uint32_t /*buffer*/, size_t /*offset*/, size_t /*bytes*/)
+{
+	counters.state_changes++;
+}
+
+void NullBackend::Viewport(int /*width*/, int /*height*/)
+{
+}
+
+void NullBackend::Clear(glm::vec3 /*color*/)
+{
+}
+
+void NullBackend::ReadFramebuffer(uint32_t /*buffer*/, int /*width*/, int /*height*/)
+{
+	counters.framebuffer_reads++;
+}
+
+void NullBackend::DrawInstanced(uint32_t /*first_index*/, uint32_t index_count, uint32_t /*base_vertex*/, uint32_t /*base_instance*/, uint32_t instance_count)
+{
+	counters.draw_calls++;
+	counters.triangles += static_cast<size_t>(index_count / 3) * instance_count;
+	counters.instances += instance_count;
+}
+
+void NullBackend::MultiDrawIndirect(uint32_t /*command_buffer*/, size_t /*first_command*/, size_t /*count*/)
+{
+	counters.draw_calls++;
+}
+
+void NullBackend::DispatchCompute(uint32_t /*groups*/)
+{
+	counters.dispatches++;
+}
+
+void NullBackend::ComputeBarrier()
+{
+}
+
+RenderFence NullBackend::InsertFence()
+{
+	return &signaled_fence;
+}
+
+bool NullBackend::WaitFence(RenderFence /*fence*/, uint64_t /*timeout_ns*/)
+{
+	return true;
+}
+
+void NullBackend::DeleteFence(RenderFence /*fence*/)
+{
+}
@@ -0,0 +1,95 @@
+#pragma once
+#include <unordered_map>
+#include <vector>
+#include "RenderBackend.h"
+
+//what was asked of the GPU since the last ResetCounters
+struct NullBackendCounters
+{
+	//DrawInstanced and MultiDrawIndirect calls
+	size_t draw_calls = 0;
+	//of DrawInstanced, indirect draws take their counts from GPU memory and add none
+	size_t triangles = 0;
+	size_t instances = 0;
+	//through UploadBuffer, writes into mapped buffers are made by the caller and counted by StreamBuffer
+	size_t bytes_uploaded = 0;
+	//bindings and programs that got past GLStateCache
+	size_t state_changes = 0;
+	size_t dispatches = 0;
+	size_t framebuffer_reads = 0;
+};
+
+//a backend without a GPU, calls are counted and dropped so the CPU side of rendering can be measured anywhere.
+//Mapped and readback buffers are real memory so streaming costs what it does on GL, everything else has no storage,
+//reads give zeros, the framebuffer is never read into them and fences are always signaled
+class NullBackend : public RenderBackend
+{
+public:
+	size_t UniformAlignment() override
+	{
+		return 256;
+	}
+
+	size_t StorageAlignment() override
+	{
+		return 16;
+	}
+
+	uint32_t CreateBuffer(size_t bytes, bool gpu_written = false) override;
+	uint32_t CreateMappedBuffer(size_t bytes, void** out_mapped) override;
+	uint32_t CreateReadbackBuffer(size_t bytes, void** out_mapped) override;
+	void UploadBuffer(uint32_t buffer, size_t offset, const void* data, size_t bytes) override;
+	void CopyBuffer(uint32_t source, uint32_t destination, size_t bytes) override;
+	void ReadBuffer(uint32_t buffer, size_t offset, void* data, size_t bytes) override;
+	void DeleteBuffer(uint32_t buffer) override;
+
+	uint32_t CreateVertexArray(VertexFormat format, uint32_t vertex_buffer, size_t stride, uint32_t index_buffer) override;
+	void SetVertexArrayBuffers(uint32_t vertex_array, uint32_t vertex_buffer, size_t stride, uint32_t index_buffer) override;
+	void DeleteVertexArray(uint32_t vertex_array) override;
+
+	void DeleteProgram(uint32_t program) override;
+	void SetUniformVec4(uint32_t program, int location, const glm::vec4* values, int count) override;
+	void SetUniformInt(uint32_t program, int location, int32_t value) override;
+	void SetUniformUint(uint32_t program, int location, uint32_t value) override;
+
+	void UseProgram(uint32_t program) override;
+	void BindVertexArray(uint32_t vertex_array) override;
+	void BindVertexBuffer(uint32_t binding, uint32_t buffer, size_t offset, size_t stride) override;
+	void BindUniformRange(uint32_t index, uint32_t buffer, size_t offset, size_t bytes) override;
+	void BindStorageRange(uint32_t index, uint32_t buffer, size_t offset, size_t bytes) override;
+
+	void Viewport(int width, int height) override;
+	void Clear(glm::vec3 color) override;
+	void ReadFramebuffer(uint32_t buffer, int width, int height) override;
+
+	void DrawInstanced(uint32_t first_index, uint32_t index_count, uint32_t base_vertex, uint32_t base_instance, uint32_t instance_count) override;
+	void MultiDrawIndirect(uint32_t command_buffer, size_t first_command, size_t count) override;
+	void DispatchCompute(uint32_t groups) override;
+	void ComputeBarrier() override;
+
+	RenderFence InsertFence() override;
+	bool WaitFence(RenderFence fence, uint64_t timeout_ns) override;
+	void DeleteFence(RenderFence fence) override;
+
+	const NullBackendCounters& Counters() const
+	{
+		return counters;
+	}
+
+	void ResetCounters()
+	{
+		counters = NullBackendCounters();
+	}
+
+	//buffers and vertex arrays not deleted yet
+	size_t LiveObjects() const
+	{
+		return live_objects;
+	}
+
+private:
+	uint32_t next_name = 1;
+	size_t live_objects = 0;
+	std::unordered_map<uint32_t, std::vector<uint8_t>> mapped;
+	NullBackendCounters counters;
+};
@@ -0,0 +1,152 @@
+#include "Profiler.h"
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+std::atomic<bool> Profiler::enabled(false);
+
+namespace
+{
+	struct ZoneEvent
+	{
+		const char* name;
+		uint64_t start;
+		uint64_t end;
+	};
+
+	//zones of one thread, only the owning thread appends, the lock is there for WriteTrace and Clear
+	struct ThreadBuffer
+	{
+		std::mutex lock;
+		std::vector<ZoneEvent> zones;
+		std::string name;
+		uint32_t id = 0;
+		uint64_t dropped = 0;
+	};
+
+	//a thread records at most this many zones between two Clear calls, about 100MB
+	const size_t max_thread_zones = 1 << 22;
+
+	const std::chrono::steady_clock::time_point profiler_epoch = std::chrono::steady_clock::now();
+
+	//buffers outlive their threads so zones of finished threads still make it into the trace
+	std::mutex buffers_lock;
+	std::vector<std::unique_ptr<ThreadBuffer>> buffers;
+
+	thread_local ThreadBuffer* thread_buffer = nullptr;
+
+	ThreadBuffer& LocalBuffer()
+	{
+		if (thread_buffer == nullptr)
+		{
+			std::lock_guard<std::mutex> guard(buffers_lock);
+			buffers.push_back(std::make_unique<ThreadBuffer>());
+			thread_buffer = buffers.back().get();
+			thread_buffer->id = static_cast<uint32_t>(buffers.size());
+		}
+
+		return *thread_buffer;
+	}
+
+	void WriteJsonString(FILE* out, const char* text)
+	{
+		fputc('"', out);
+		for (const char* c = text; *c != '\0'; c++)
+		{
+			if (*c == '"' || *c == '\\')
+				fputc('\\', out);
+			if (static_cast<unsigned char>(*c) >= 0x20)
+				fputc(*c, out);
+		}
+		fputc('"', out);
+	}
+}
+
+uint64_t Profiler::Now()
+{
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - profiler_epoch).count();
+}
+
+void Profiler::Record(const char* name, uint64_t start, uint64_t end)
+{
+	ThreadBuffer& buffer = LocalBuffer();
+	std::lock_guard<std::mutex> guard(buffer.lock);
+
+	if (buffer.zones.size() < max_thread_zones)
+		buffer.zones.push_back({ name, start, end });
+	else
+		buffer.dropped++;
+}
+
+void Profiler::SetThreadName(const char* name)
+{
+	ThreadBuffer& buffer = LocalBuffer();
+	std::lock_guard<std::mutex> guard(buffer.lock);
+	buffer.name = name;
+}
+
+bool Profiler::WriteTrace(const char* path)
+{
+	FILE* out = fopen(path, "w");
+	if (out == nullptr)
+	{
+		printf("Failed to write trace to %s\n", path);
+		return false;
+	}
+
+	std::lock_guard<std::mutex> guard(buffers_lock);
+	bool first = true;
+	uint64_t dropped = 0;
+	size_t written = 0;
+
+	fprintf(out, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[");
+
+	for (std::unique_ptr<ThreadBuffer>& buffer : buffers)
+	{
+		std::lock_guard<std::mutex> buffer_guard(buffer->lock);
+
+		if (buffer->name.empty() == false)
+		{
+			fprintf(out, "%s\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":", first ? "" : ",", buffer->id);
+			WriteJsonString(out, buffer->name.c_str());
+			fprintf(out, "}}");
+			first = false;
+		}
+
+		//complete events, timestamps in microseconds
+		for (const ZoneEvent& zone : buffer->zones)
+		{
+			fprintf(out, "%s\n{\"name\":", first ? "" : ",");
+			WriteJsonString(out, zone.name);
+			fprintf(out, ",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}", buffer->id, zone.start * 1e-3, (zone.end - zone.start) * 1e-3);
+			first = false;
+		}
+
+		written += buffer->zones.size();
+		dropped += buffer->dropped;
+	}
+
+	fprintf(out, "\n]}\n");
+	fclose(out);
+
+	printf("Trace with %zu zones written to %s\n", written, path);
+	if (dropped > 0)
+		printf("%llu zones didn't fit into the thread buffers\n", static_cast<unsigned long long>(dropped));
+
+	return true;
+}
+
+void Profiler::Clear()
+{
+	std::lock_guard<std::mutex> guard(buffers_lock);
+
+	for (std::unique_ptr<ThreadBuffer>& buffer : buffers)
+	{
+		std::lock_guard<std::mutex> buffer_guard(buffer->lock);
+		buffer->zones.clear();
+		buffer->dropped = 0;
+	}
+}
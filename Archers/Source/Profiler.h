@@ -0,0 +1,76 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+
+//zones are compiled out entirely with ARCHERS_PROFILE=0, otherwise they cost a relaxed load and a branch
+//while the profiler is disabled
+#ifndef ARCHERS_PROFILE
+#define ARCHERS_PROFILE 1
+#endif
+
+//collects timed zones from every thread into per-thread buffers and writes them
+//as a chrome://tracing / Perfetto JSON trace
+class Profiler
+{
+public:
+	static void SetEnabled(bool enable)
+	{
+		enabled.store(enable, std::memory_order_relaxed);
+	}
+
+	static bool IsEnabled()
+	{
+		return enabled.load(std::memory_order_relaxed);
+	}
+
+	//nanoseconds since the first call
+	static uint64_t Now();
+	//name has to outlive the profiler, zones are named with string literals
+	static void Record(const char* name, uint64_t start, uint64_t end);
+	//shown instead of the thread id in the trace viewer
+	static void SetThreadName(const char* name);
+
+	//writes every zone recorded so far, threads may keep recording meanwhile
+	static bool WriteTrace(const char* path);
+	//drops recorded zones, thread names are kept
+	static void Clear();
+
+private:
+	static std::atomic<bool> enabled;
+};
+
+class ProfileZone
+{
+public:
+	ProfileZone(const char* zone_name)
+	{
+		if (Profiler::IsEnabled())
+		{
+			name = zone_name;
+			start = Profiler::Now();
+		}
+	}
+
+	~ProfileZone()
+	{
+		if (name != nullptr)
+			Profiler::Record(name, start, Profiler::Now());
+	}
+
+	ProfileZone(const ProfileZone&) = delete;
+	ProfileZone& operator=(const ProfileZone&) = delete;
+
+private:
+	const char* name = nullptr;
+	uint64_t start = 0;
+};
+
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+
+#if ARCHERS_PROFILE
+//times the rest of the enclosing scope
+#define PROFILE_ZONE(name) ProfileZone PROFILE_CONCAT(profile_zone_, __LINE__)(name)
+#else
+#define PROFILE_ZONE(name)
+#endif
@@ -0,0 +1,173 @@
+#include "ProgramCache.h"
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include "Hash.h"
+
+//start of every cache file, followed by the binary itself
+struct ProgramBinaryHeader
+{
+	uint32_t magic;
+	uint32_t format;
+	uint64_t key;
+	uint64_t length;
+};
+
+static const uint32_t program_binary_magic = 0x42505241; //"ARPB"
+
+ProgramCache::ProgramCache(const std::string& cache_directory)
+{
+	directory = cache_directory;
+
+	const char* strings[3] = { reinterpret_cast<const char*>(glGetString(GL_VENDOR)), reinterpret_cast<const char*>(glGetString(GL_RENDERER)),
+		reinterpret_cast<const char*>(glGetString(GL_VERSION)) };
+	for (const char* string : strings)
+	{
+		driver += string != nullptr ? string : "";
+		driver += '\n';
+	}
+
+	//a driver may expose the API with no format to save in
+	int formats = 0;
+	glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+	binaries_supported = formats > 0;
+
+	std::error_code error;
+	std::filesystem::create_directories(directory, error);
+}
+
+uint32_t ProgramCache::Load(const char* vertex_source, const char* fragment_source)
+{
+	Stage stages[2] = { { vertex_source, GL_VERTEX_SHADER }, { fragment_source, GL_FRAGMENT_SHADER } };
+	return Load(stages, 2);
+}
+
+uint32_t ProgramCache::LoadCompute(const char* compute_source)
+{
+	Stage stage = { compute_source, GL_COMPUTE_SHADER };
+	return Load(&stage, 1);
+}
+
+uint32_t ProgramCache::Load(const Stage* stages, int count)
+{
+	auto start = std::chrono::steady_clock::now();
+
+	uint64_t key = Fnv1a(driver.data(), driver.size());
+	//the terminators keep "ab" + "c" and "a" + "bc" apart
+	for (int i = 0; i < count; i++)
+	{
+		key = Fnv1a(stages[i].source, strlen(stages[i].source) + 1, key);
+	}
+
+	char name[32];
+	snprintf(name, sizeof(name), "%016llx.bin", static_cast<unsigned long long>(key));
+	std::string path = directory + "/" + name;
+
+	uint32_t program = binaries_supported ? LoadBinary(path, key) : 0;
+	last_hit = program != 0;
+
+	if (program == 0)
+	{
+		program = Compile(stages, count);
+		if (program != 0 && binaries_supported)
+			StoreBinary(program, path, key);
+	}
+
+	if (program != 0 && binaries_supported)
+	{
+		program_paths[program] = path;
+		path_users[path]++;
+	}
+
+	last_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	return program;
+}
+
+void ProgramCache::Replaced(uint32_t program)
+{
+	auto found = program_paths.find(program);
+	if (found == program_paths.end())
+		return;
+
+	std::string path = found->second;
+	program_paths.erase(found);
+	if (--path_users[path] > 0)
+		return;
+
+	path_users.erase(path);
+	std::error_code error;
+	std::filesystem::remove(path, error);
+}
+
+uint32_t ProgramCache::LoadBinary(const std::string& path, uint64_t key)
+{
+	std::vector<char> file = FileManager::ReadBinaryFile(path);
+	if (file.size() < sizeof(ProgramBinaryHeader))
+		return 0;
+
+	ProgramBinaryHeader header;
+	memcpy(&header, file.data(), sizeof(header));
+	if (header.magic != program_binary_magic || header.key != key || header.length != file.size() - sizeof(header))
+		return 0;
+
+	uint32_t program = glCreateProgram();
+	glProgramBinary(program, header.format, file.data() + sizeof(header), static_cast<GLsizei>(header.length));
+
+	//the driver may reject a binary it wrote itself, after an update of something the key doesn't cover
+	int success = 0;
+	glGetProgramiv(program, GL_LINK_STATUS, &success);
+	if (!success)
+	{
+		printf("program cache: %s rejected by the driver, compiling\n", path.c_str());
+		glDeleteProgram(program);
+		return 0;
+	}
+
+	return program;
+}
+
+uint32_t ProgramCache::Compile(const Stage* stages, int count)
+{
+	uint32_t program = glCreateProgram();
+	glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+
+	//every stage is compiled so all their errors are printed at once
+	bool res = true;
+	for (int i = 0; i < count; i++)
+	{
+		res = res & OpenGLAPI::GLCompileShader(stages[i].source, stages[i].type, program);
+	}
+	res = res && OpenGLAPI::GLLinkProgram(program);
+
+	if (!res)
+	{
+		glDeleteProgram(program);
+		return 0;
+	}
+
+	return program;
+}
+
+void ProgramCache::StoreBinary(uint32_t program, const std::string& path, uint64_t key)
+{
+	int length = 0;
+	glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+	if (length <= 0)
+		return;
+
+	std::vector<char> file(sizeof(ProgramBinaryHeader) + length);
+	GLenum format = 0;
+	glGetProgramBinary(program, length, &length, &format, file.data() + sizeof(ProgramBinaryHeader));
+
+	ProgramBinaryHeader header;
+	header.magic = program_binary_magic;
+	header.format = format;
+	header.key = key;
+	header.length = static_cast<uint64_t>(length);
+	memcpy(file.data(), &header, sizeof(header));
+	file.resize(sizeof(header) + length);
+
+	if (!FileManager::WriteBinaryFile(path, file))
+		printf("program cache: couldn't write %s\n", path.c_str());
+}
@@ -0,0 +1,54 @@
+#pragma once
+#include <string>
+#include <unordered_map>
+#include "GLAPI.h"
+
+//linked programs kept on disk as driver binaries, a launch with the same sources on the same driver skips
+//compiling and linking, anything the driver refuses to load is compiled from source and stored again
+class ProgramCache
+{
+public:
+	//binaries are stored as files in cache_directory, it is created when missing
+	ProgramCache(const std::string& cache_directory);
+
+	//program built from a vertex and a fragment shader, 0 when they fail to compile or link
+	uint32_t Load(const char* vertex_source, const char* fragment_source);
+	//program of a single compute shader, 0 when it fails to compile or link
+	uint32_t LoadCompute(const char* compute_source);
+	//called once a loaded program is deleted for a new one, its binary is removed unless a loaded program
+	//still uses it, so reloading edited shaders doesn't leave a file behind for every edit
+	void Replaced(uint32_t program);
+
+	//whether the last Load came from the cache and how long it took
+	bool LastWasHit() const
+	{
+		return last_hit;
+	}
+
+	double LastSeconds() const
+	{
+		return last_seconds;
+	}
+
+private:
+	struct Stage
+	{
+		const char* source;
+		uint32_t type;
+	};
+
+	uint32_t Load(const Stage* stages, int count);
+	uint32_t LoadBinary(const std::string& path, uint64_t key);
+	uint32_t Compile(const Stage* stages, int count);
+	void StoreBinary(uint32_t program, const std::string& path, uint64_t key);
+
+	std::string directory;
+	//vendor, renderer and version, a driver update invalidates every binary
+	std::string driver;
+	//file of every loaded program and how many loaded programs use each file
+	std::unordered_map<uint32_t, std::string> program_paths;
+	std::unordered_map<std::string, int> path_users;
+	bool binaries_supported = false;
+	bool last_hit = false;
+	double last_seconds = 0.0;
+};
@@ -0,0 +1,81 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include "Mesh.h"
+
+//the layout glMultiDrawElementsIndirect reads
+struct DrawElementsIndirectCommand
+{
+	uint32_t count;
+	uint32_t instance_count;
+	uint32_t first_index;
+	int32_t base_vertex;
+	uint32_t base_instance;
+};
+
+//signaled once the GPU is done with the commands issued before it, null is never a valid fence
+typedef void* RenderFence;
+
+//the GPU as the renderer, the geometry arena and the stream buffer see it: buffers, programs and draw submission.
+//Buffers, vertex arrays and programs are named by the backend and 0 is never a valid name, bindings follow GL's model
+//so the GL backend forwards every call as it is. Nothing here is thread safe, calls come from the render thread
+class RenderBackend
+{
+public:
+	virtual ~RenderBackend() = default;
+
+	//offset alignment of uniform and shader storage ranges
+	virtual size_t UniformAlignment() = 0;
+	virtual size_t StorageAlignment() = 0;
+
+	//storage drawn from many times and written with UploadBuffer or CopyBuffer, gpu_written for buffers compute fills
+	virtual uint32_t CreateBuffer(size_t bytes, bool gpu_written = false) = 0;
+	//storage the CPU writes through out_mapped for as long as the buffer lives, writes are seen by the next draw
+	virtual uint32_t CreateMappedBuffer(size_t bytes, void** out_mapped) = 0;
+	//storage the GPU writes and the CPU reads through out_mapped, what was written before a signaled fence is visible there
+	virtual uint32_t CreateReadbackBuffer(size_t bytes, void** out_mapped) = 0;
+	virtual void UploadBuffer(uint32_t buffer, size_t offset, const void* data, size_t bytes) = 0;
+	//first bytes of source to the start of destination
+	virtual void CopyBuffer(uint32_t source, uint32_t destination, size_t bytes) = 0;
+	//waits for the GPU to finish writing the range
+	virtual void ReadBuffer(uint32_t buffer, size_t offset, void* data, size_t bytes) = 0;
+	//draws already issued keep reading the storage until they are done
+	virtual void DeleteBuffer(uint32_t buffer) = 0;
+
+	//vertices of the format at binding 0 and InstanceData at binding 1, advancing once per instance and attached at draw time
+	virtual uint32_t CreateVertexArray(VertexFormat format, uint32_t vertex_buffer, size_t stride, uint32_t index_buffer) = 0;
+	virtual void SetVertexArrayBuffers(uint32_t vertex_array, uint32_t vertex_buffer, size_t stride, uint32_t index_buffer) = 0;
+	virtual void DeleteVertexArray(uint32_t vertex_array) = 0;
+
+	//programs are built by the platform's loader, ProgramCache on GL, the backend only uses and deletes them
+	virtual void DeleteProgram(uint32_t program) = 0;
+	virtual void SetUniformVec4(uint32_t program, int location, const glm::vec4* values, int count) = 0;
+	virtual void SetUniformInt(uint32_t program, int location, int32_t value) = 0;
+	virtual void SetUniformUint(uint32_t program, int location, uint32_t value) = 0;
+
+	//bindings, GLStateCache skips the redundant ones before they get here
+	virtual void UseProgram(uint32_t program) = 0;
+	virtual void BindVertexArray(uint32_t vertex_array) = 0;
+	virtual void BindVertexBuffer(uint32_t binding, uint32_t buffer, size_t offset, size_t stride) = 0;
+	virtual void BindUniformRange(uint32_t index, uint32_t buffer, size_t offset, size_t bytes) = 0;
+	virtual void BindStorageRange(uint32_t index, uint32_t buffer, size_t offset, size_t bytes) = 0;
+
+	virtual void Viewport(int width, int height) = 0;
+	//color to the given one and depth to 1
+	virtual void Clear(glm::vec3 color) = 0;
+	//color of the frame being drawn as RGBA8 to the start of buffer, rows from the bottom of the image, without waiting for it
+	virtual void ReadFramebuffer(uint32_t buffer, int width, int height) = 0;
+
+	//indexed triangles of the bound program and vertex array, indices counted from the start of the index buffer
+	virtual void DrawInstanced(uint32_t first_index, uint32_t index_count, uint32_t base_vertex, uint32_t base_instance, uint32_t instance_count) = 0;
+	//count DrawElementsIndirectCommands of command_buffer starting at first_command, each drawn as DrawInstanced
+	virtual void MultiDrawIndirect(uint32_t command_buffer, size_t first_command, size_t count) = 0;
+	virtual void DispatchCompute(uint32_t groups) = 0;
+	//what compute wrote becomes visible to indirect draws, vertex attributes and buffer reads
+	virtual void ComputeBarrier() = 0;
+
+	virtual RenderFence InsertFence() = 0;
+	//true once the fence is signaled, waits up to timeout_ns and flushes the commands first when it waits at all
+	virtual bool WaitFence(RenderFence fence, uint64_t timeout_ns) = 0;
+	virtual void DeleteFence(RenderFence fence) = 0;
+};
@@ -0,0 +1,131 @@
+#include "RenderQueue.h"
+#include <algorithm>
+#include <cstring>
+#include "Profiler.h"
+
+void GLStateCache::Invalidate()
+{
+	program = unknown;
+	vertex_array = unknown;
+	for (uint32_t i = 0; i < max_cached_bindings; i++)
+	{
+		vertex_buffers[i] = { unknown, 0, 0 };
+		uniform_ranges[i] = { unknown, 0, 0 };
+	}
+}
+
+void GLStateCache::UseProgram(uint32_t new_program)
+{
+	requested++;
+	if (program == new_program)
+		return;
+
+	backend.UseProgram(new_program);
+	program = new_program;
+	issued++;
+}
+
+void GLStateCache::BindVertexArray(uint32_t new_vertex_array)
+{
+	requested++;
+	if (vertex_array == new_vertex_array)
+		return;
+
+	backend.BindVertexArray(new_vertex_array);
+	vertex_array = new_vertex_array;
+	issued++;
+
+	//vertex buffer bindings belong to the vertex array
+	for (uint32_t i = 0; i < max_cached_bindings; i++)
+	{
+		vertex_buffers[i] = { unknown, 0, 0 };
+	}
+}
+
+void GLStateCache::BindVertexBuffer(uint32_t binding, uint32_t buffer, size_t offset, size_t stride)
+{
+	requested++;
+	if (binding < max_cached_bindings)
+	{
+		BufferRange& cached = vertex_buffers[binding];
+		if (cached.buffer == buffer && cached.offset == offset && cached.size == stride)
+			return;
+		cached = { buffer, offset, stride };
+	}
+
+	backend.BindVertexBuffer(binding, buffer, offset, stride);
+	issued++;
+}
+
+void GLStateCache::BindUniformRange(uint32_t index, uint32_t buffer, size_t offset, size_t size)
+{
+	requested++;
+	if (index < max_cached_bindings)
+	{
+		BufferRange& cached = uniform_ranges[index];
+		if (cached.buffer == buffer && cached.offset == offset && cached.size == size)
+			return;
+		cached = { buffer, offset, size };
+	}
+
+	backend.BindUniformRange(index, buffer, offset, size);
+	issued++;
+}
+
+uint64_t RenderQueue::MakeKey(uint32_t program_slot, uint32_t mesh_id, uint16_t material, float depth)
+{
+	//non-negative floats sort the same as their bit patterns, the top 24 bits keep the exponent and 15 bits of mantissa
+	float clamped = std::max(depth, 0.f);
+	uint32_t depth_bits;
+	memcpy(&depth_bits, &clamped, sizeof(depth_bits));
+
+	return static_cast<uint64_t>(program_slot & 0xFF) << 56 | static_cast<uint64_t>(mesh_id & 0xFFFF) << 40 | static_cast<uint64_t>(material) << 24 | depth_bits >> 7;
+}
+
+void RenderQueue::Clear()
+{
+	commands.clear();
+	items.clear();
+	programs.clear();
+}
+
+uint32_t RenderQueue::ProgramSlot(uint32_t program)
+{
+	//a frame uses a handful of programs, past 256 slots draws are still right but may share less state
+	for (size_t i = 0; i < programs.size(); i++)
+	{
+		if (programs[i] == program)
+			return static_cast<uint32_t>(i);
+	}
+
+	programs.push_back(program);
+	return static_cast<uint32_t>(programs.size() - 1);
+}
+
+void RenderQueue::Submit(const DrawCommand& command, uint16_t material, float depth)
+{
+	items.push_back({ MakeKey(ProgramSlot(command.program), command.mesh->Id(), material, depth), static_cast<uint32_t>(commands.size()) });
+	commands.push_back(command);
+}
+
+void RenderQueue::Execute(RenderBackend& backend, GLStateCache& state)
+{
+	PROFILE_ZONE("RenderQueue");
+
+	std::sort(items.begin(), items.end(), [](const SortItem& a, const SortItem& b)
+	{
+		return a.key < b.key;
+	});
+
+	for (const SortItem& item : items)
+	{
+		const DrawCommand& command = commands[item.command];
+
+		state.UseProgram(command.program);
+		state.BindVertexArray(command.mesh->VertexArray());
+		state.BindVertexBuffer(1, command.instance_buffer, command.instance_offset, command.instance_stride);
+		//the mesh is a range of the arena's shared buffers
+		backend.DrawInstanced(command.mesh->FirstIndex(), static_cast<uint32_t>(command.mesh->NumIndices()), command.mesh->BaseVertex(),
+			command.base_instance, command.instance_count);
+	}
+}
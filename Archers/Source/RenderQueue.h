@@ -0,0 +1,107 @@
+#pragma once
+#include "RenderBackend.h"
+
+//the binding state draws depend on, calls setting what is already set are skipped and counted,
+//the rest are passed on to the backend
+class GLStateCache
+{
+public:
+	GLStateCache(RenderBackend& state_backend) : backend(state_backend)
+	{
+		Invalidate();
+	}
+
+	//the next call of every kind is issued, for when code outside the cache may have changed the state
+	void Invalidate();
+
+	void UseProgram(uint32_t program);
+	void BindVertexArray(uint32_t vertex_array);
+	//binding of the bound vertex array, changing the vertex array forgets it
+	void BindVertexBuffer(uint32_t binding, uint32_t buffer, size_t offset, size_t stride);
+	void BindUniformRange(uint32_t index, uint32_t buffer, size_t offset, size_t size);
+
+	//state changes asked for and the ones that reached the backend since the last ResetCounters
+	uint64_t Requested() const
+	{
+		return requested;
+	}
+
+	uint64_t Issued() const
+	{
+		return issued;
+	}
+
+	void ResetCounters()
+	{
+		requested = 0;
+		issued = 0;
+	}
+
+private:
+	struct BufferRange
+	{
+		uint32_t buffer;
+		size_t offset;
+		size_t size;
+	};
+
+	static const uint32_t max_cached_bindings = 4;
+	//0 is a valid name for all of these, so unknown state is kept apart
+	static const uint32_t unknown = 0xFFFFFFFF;
+
+	RenderBackend& backend;
+	uint32_t program = unknown;
+	uint32_t vertex_array = unknown;
+	BufferRange vertex_buffers[max_cached_bindings];
+	BufferRange uniform_ranges[max_cached_bindings];
+
+	uint64_t requested = 0;
+	uint64_t issued = 0;
+};
+
+struct DrawCommand
+{
+	uint32_t program;
+	Mesh* mesh;
+	//instance attributes, read through vertex buffer binding 1 starting at instance base_instance, draws
+	//sharing a buffer range keep the binding and only move base_instance
+	uint32_t instance_buffer;
+	size_t instance_offset;
+	size_t instance_stride;
+	uint32_t base_instance;
+	uint32_t instance_count;
+};
+
+//draws of a frame, executed ordered by program, mesh, material and then front to back so that
+//consecutive draws share as much state as possible
+class RenderQueue
+{
+public:
+	//program slot and mesh take the high bits, depth is view distance and only orders draws of equal state,
+	//program_slot is the program's index among the frame's programs as GL names don't fit in 8 bits
+	static uint64_t MakeKey(uint32_t program_slot, uint32_t mesh_id, uint16_t material, float depth);
+
+	void Clear();
+	//material is reserved until there are materials, every draw passes 0 and it doesn't change any state
+	void Submit(const DrawCommand& command, uint16_t material, float depth);
+	void Execute(RenderBackend& backend, GLStateCache& state);
+
+	size_t Size() const
+	{
+		return commands.size();
+	}
+
+private:
+	struct SortItem
+	{
+		uint64_t key;
+		uint32_t command;
+	};
+
+	uint32_t ProgramSlot(uint32_t program);
+
+	std::vector<DrawCommand> commands;
+	std::vector<SortItem> items;
+	//programs of the frame in the order they were first submitted, a program's slot is its index
+	std::vector<uint32_t> programs;
+};
@@ -0,0 +1,82 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <vector>
+#include <glm.hpp>
+#include <gtc/quaternion.hpp>
+
+struct Mesh;
+
+//a moving object as the simulation left it, the renderer interpolates between the two transforms
+struct SnapshotObject
+{
+	Mesh* mesh;
+	//index of the entity, the same every tick for as long as the object lives, and its version that tells
+	//a new object apart from a dead one whose index it reuses
+	uint32_t object;
+	uint32_t version;
+	glm::vec3 prev_position;
+	glm::vec3 position;
+	glm::quat prev_rotation;
+	glm::quat rotation;
+	glm::vec3 scale;
+	glm::vec3 color;
+};
+
+//everything the render thread needs from one simulation tick, never changed once published
+struct RenderSnapshot
+{
+	std::vector<SnapshotObject> objects;
+	uint64_t tick = 0;
+	double tick_length = 0.05;
+	//time of the caller's clock the snapshot was published at and how far into the next tick the simulation was
+	double published = 0.0;
+	double published_alpha = 0.0;
+	//simulated seconds per real second, 0 while paused
+	double rate = 0.0;
+
+	//fraction of a tick passed since the snapshot's tick at the given time, clamped so nothing is extrapolated
+	float Alpha(double now) const
+	{
+		double alpha = published_alpha + (now - published) * rate / tick_length;
+		return static_cast<float>(glm::clamp(alpha, 0.0, 1.0));
+	}
+};
+
+//triple buffer, the writer fills one snapshot while the reader holds another and the third is the latest
+//published one, neither side ever waits for the other
+class SnapshotBuffer
+{
+public:
+	//snapshot the writer fills before Publish
+	RenderSnapshot& WriteBuffer()
+	{
+		return buffers[back];
+	}
+
+	void Publish()
+	{
+		back = middle.exchange(back | fresh_bit, std::memory_order_acq_rel) & index_mask;
+	}
+
+	//latest published snapshot, stays valid and unchanged until the next Read
+	const RenderSnapshot& Read()
+	{
+		if (middle.load(std::memory_order_relaxed) & fresh_bit)
+			front = middle.exchange(front, std::memory_order_acq_rel) & index_mask;
+
+		return buffers[front];
+	}
+
+private:
+	static const int fresh_bit = 4;
+	static const int index_mask = 3;
+
+	RenderSnapshot buffers[3];
+	//owned by the writer
+	int back = 0;
+	//handed over between the two, with fresh_bit set when it is newer than the reader's
+	std::atomic<int> middle{ 1 };
+	//owned by the reader
+	int front = 2;
+};
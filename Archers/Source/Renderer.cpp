@@ -0,0 +1,314 @@
+#include "Renderer.h"
+#include <cfloat>
+#include <cstring>
+#include <algorithm>
+#include <gtc/type_ptr.hpp>
+#include "Profiler.h"
+
+//cull.comp copies instances as 13 floats
+static_assert(sizeof(InstanceData) == 13 * sizeof(float), "InstanceData has to stay tightly packed");
+
+InstancedRenderer::InstancedRenderer(RenderBackend& render_backend, StreamBuffer& frame_stream)
+	: backend(render_backend), stream(frame_stream), state(render_backend), gpu_culler(render_backend)
+{
+	size_t alignment = backend.UniformAlignment();
+	if (alignment > 0)
+		uniform_alignment = alignment;
+
+	alignment = backend.StorageAlignment();
+	if (alignment > 0)
+		storage_alignment = alignment;
+}
+
+void InstancedRenderer::Begin()
+{
+	for (Batch& batch : batches)
+	{
+		batch.instances.clear();
+		batch.spheres.Clear();
+	}
+	draw_calls = 0;
+	instance_count = 0;
+	triangle_count = 0;
+	cull_stats = CullStats();
+	queue.Clear();
+	//the rest of the frame may have touched the bindings
+	state.Invalidate();
+	state.ResetCounters();
+}
+
+void InstancedRenderer::SetCamera(const glm::mat4& projection, const glm::mat4& view)
+{
+	//std140 layout of the Camera block, two column major matrices
+	StreamAllocation camera = stream.Allocate(2 * sizeof(glm::mat4), uniform_alignment);
+	memcpy(camera.data, glm::value_ptr(projection), sizeof(glm::mat4));
+	memcpy(static_cast<uint8_t*>(camera.data) + sizeof(glm::mat4), glm::value_ptr(view), sizeof(glm::mat4));
+	state.BindUniformRange(0, camera.buffer, camera.offset, 2 * sizeof(glm::mat4));
+
+	view_matrix = view;
+	glm::mat4 view_projection = projection * view;
+	frustum = Frustum::FromMatrix(view_projection);
+	clip_w_row = glm::vec4(view_projection[0][3], view_projection[1][3], view_projection[2][3], view_projection[3][3]);
+	projection_scale = projection[1][1];
+	has_camera = true;
+}
+
+void InstancedRenderer::Add(Mesh* mesh, glm::vec3 position, glm::quat rotation, glm::vec3 scale, glm::vec3 color, uint32_t object, uint32_t version)
+{
+	//the mesh sphere scaled by the largest axis still holds the scaled mesh
+	glm::vec3 center = position + rotation * (scale * mesh->BoundsCenter());
+	float radius = mesh->BoundsRadius() * glm::max(scale.x, glm::max(scale.y, scale.z));
+
+	if (mesh->Lods() != nullptr)
+		mesh = SelectLod(mesh, center, radius, object, version);
+
+	uint32_t batch_program = program;
+	if (mesh->Format() == VertexFormat::Packed)
+	{
+		//positions come out of the shader in [0, 1] of the mesh AABB, the AABB is folded into the transform
+		batch_program = packed_program;
+		position += rotation * (scale * mesh->PackOffset());
+		scale *= mesh->PackScale();
+	}
+
+	Batch& batch = FindBatch(mesh, batch_program);
+	batch.instances.push_back({ glm::vec4(rotation.x, rotation.y, rotation.z, rotation.w), position, scale, color });
+	batch.spheres.Add(center, radius);
+}
+
+void InstancedRenderer::Draw()
+{
+	if (GpuCulling())
+	{
+		DrawIndirect();
+		return;
+	}
+
+	PROFILE_ZONE("InstancedDraw");
+
+	size_t total = 0;
+	for (Batch& batch : batches)
+	{
+		if (culling && has_camera)
+		{
+			FrustumCuller::Cull(frustum, batch.spheres, batch.visible);
+		}
+		else
+		{
+			batch.visible.resize(batch.instances.size());
+			for (size_t i = 0; i < batch.visible.size(); i++)
+			{
+				batch.visible[i] = static_cast<uint32_t>(i);
+			}
+		}
+
+		cull_stats.tested += batch.instances.size();
+		total += batch.visible.size();
+	}
+	cull_stats.visible = total;
+
+	if (total == 0)
+		return;
+
+	//written straight into the mapped buffer, no staging copy and no driver side copy
+	StreamAllocation allocation = stream.Allocate(total * sizeof(InstanceData));
+	InstanceData* instances = static_cast<InstanceData*>(allocation.data);
+
+	//view distance is the depth row of the view matrix
+	glm::vec4 depth_row = -glm::vec4(view_matrix[0][2], view_matrix[1][2], view_matrix[2][2], view_matrix[3][2]);
+
+	size_t first = 0;
+	for (Batch& batch : batches)
+	{
+		if (batch.visible.empty())
+			continue;
+
+		float nearest = FLT_MAX;
+		for (size_t i = 0; i < batch.visible.size(); i++)
+		{
+			const InstanceData& instance = batch.instances[batch.visible[i]];
+			instances[first + i] = instance;
+			nearest = glm::min(nearest, glm::dot(depth_row, glm::vec4(instance.position, 1.f)));
+		}
+
+		//color is a per-instance attribute, material 0 is the only one until materials exist
+		DrawCommand command = { batch.program, batch.mesh, allocation.buffer, allocation.offset, sizeof(InstanceData), static_cast<uint32_t>(first),
+			static_cast<uint32_t>(batch.visible.size()) };
+		queue.Submit(command, 0, nearest);
+
+		first += batch.visible.size();
+		triangle_count += batch.visible.size() * batch.mesh->NumIndices() / 3;
+		draw_calls++;
+	}
+
+	queue.Execute(backend, state);
+
+	instance_count = total;
+}
+
+void InstancedRenderer::DrawIndirect()
+{
+	PROFILE_ZONE("IndirectDraw");
+
+	//a multi draw shares one program and vertex array, so batches are grouped by both
+	indirect_batches.clear();
+	size_t total = 0;
+	for (size_t i = 0; i < batches.size(); i++)
+	{
+		if (batches[i].instances.empty())
+			continue;
+
+		indirect_batches.push_back(i);
+		total += batches[i].instances.size();
+	}
+	std::stable_sort(indirect_batches.begin(), indirect_batches.end(), [this](size_t a, size_t b)
+	{
+		if (batches[a].program != batches[b].program)
+			return batches[a].program < batches[b].program;
+		return batches[a].mesh->VertexArray() < batches[b].mesh->VertexArray();
+	});
+
+	cull_stats.tested = total;
+	indirect_culled = culling && has_camera;
+	indirect_commands.clear();
+	if (total == 0)
+		return;
+
+	StreamAllocation instances = stream.Allocate(total * sizeof(InstanceData), storage_alignment);
+	StreamAllocation spheres = stream.Allocate(total * sizeof(glm::vec4), storage_alignment);
+	StreamAllocation draw_ids = stream.Allocate(total * sizeof(uint32_t), storage_alignment);
+	InstanceData* instance_data = static_cast<InstanceData*>(instances.data);
+	glm::vec4* sphere_data = static_cast<glm::vec4*>(spheres.data);
+	uint32_t* draw_data = static_cast<uint32_t*>(draw_ids.data);
+
+	size_t first = 0;
+	for (size_t batch_index : indirect_batches)
+	{
+		const Batch& batch = batches[batch_index];
+		uint32_t draw = static_cast<uint32_t>(indirect_commands.size());
+		memcpy(instance_data + first, batch.instances.data(), batch.instances.size() * sizeof(InstanceData));
+		for (size_t i = 0; i < batch.instances.size(); i++)
+		{
+			sphere_data[first + i] = glm::vec4(batch.spheres.x[i], batch.spheres.y[i], batch.spheres.z[i], batch.spheres.radius[i]);
+			draw_data[first + i] = draw;
+		}
+
+		indirect_commands.push_back({ static_cast<uint32_t>(batch.mesh->NumIndices()), 0, batch.mesh->FirstIndex(),
+			static_cast<int32_t>(batch.mesh->BaseVertex()), static_cast<uint32_t>(first) });
+		first += batch.instances.size();
+	}
+
+	gpu_culler.Cull(state, frustum, indirect_culled, instances, spheres, draw_ids, total, indirect_commands);
+
+	for (size_t start = 0; start < indirect_batches.size();)
+	{
+		const Batch& batch = batches[indirect_batches[start]];
+		size_t end = start + 1;
+		while (end < indirect_batches.size() && batches[indirect_batches[end]].program == batch.program &&
+			batches[indirect_batches[end]].mesh->VertexArray() == batch.mesh->VertexArray())
+		{
+			end++;
+		}
+
+		state.UseProgram(batch.program);
+		state.BindVertexArray(batch.mesh->VertexArray());
+		state.BindVertexBuffer(1, gpu_culler.InstanceBuffer(), 0, sizeof(InstanceData));
+		backend.MultiDrawIndirect(gpu_culler.CommandBuffer(), start, end - start);
+
+		draw_calls++;
+		start = end;
+	}
+
+	//visible instances and triangles stay on the GPU, VerifyGpuCulling reads them back
+}
+
+GpuCullCheck InstancedRenderer::VerifyGpuCulling()
+{
+	GpuCullCheck check;
+	if (!GpuCulling())
+		return check;
+
+	std::vector<DrawElementsIndirectCommand> culled;
+	std::vector<uint32_t> gpu_visible;
+	gpu_culler.ReadBack(culled, gpu_visible);
+
+	//batches and the frustum are still those of the last frame until the next Begin
+	for (size_t i = 0; i < culled.size() && i < indirect_batches.size(); i++)
+	{
+		Batch& batch = batches[indirect_batches[i]];
+		if (indirect_culled)
+		{
+			FrustumCuller::CullScalar(frustum, batch.spheres, batch.visible);
+		}
+		else
+		{
+			batch.visible.resize(batch.instances.size());
+			for (size_t j = 0; j < batch.visible.size(); j++)
+			{
+				batch.visible[j] = static_cast<uint32_t>(j);
+			}
+		}
+
+		//the shader appends in whatever order its invocations finish
+		auto first = gpu_visible.begin() + culled[i].base_instance;
+		std::sort(first, first + culled[i].instance_count);
+		if (batch.visible.size() != culled[i].instance_count || !std::equal(batch.visible.begin(), batch.visible.end(), first))
+			check.mismatched_draws++;
+
+		check.draws++;
+		check.visible += culled[i].instance_count;
+		check.triangles += culled[i].instance_count * (culled[i].count / 3);
+	}
+
+	cull_stats.visible = check.visible;
+	instance_count = check.visible;
+	triangle_count = check.triangles;
+	return check;
+}
+
+Mesh* InstancedRenderer::SelectLod(Mesh* mesh, glm::vec3 center, float radius, uint32_t object, uint32_t version)
+{
+	const LodChain& chain = *mesh->Lods();
+	if (lod == false || has_camera == false)
+		return chain.Finest();
+
+	//diameter in pixels, w is 1 for an orthographic camera and the view depth for a perspective one
+	float w = glm::max(glm::dot(clip_w_row, glm::vec4(center, 1.f)), 1e-3f);
+	float pixels = 2.f * radius * projection_scale / w * 0.5f * viewport_height;
+
+	if (object == no_object)
+		return chain.meshes[chain.Select(pixels, -1)];
+
+	//indices are recycled by the registry, so this stays as long as the most objects alive at once
+	if (object >= object_lods.size())
+		object_lods.resize(object + 1, { 0, 0xFF });
+
+	ObjectLod& state = object_lods[object];
+	int previous = state.level == 0xFF || state.version != version ? -1 : state.level;
+	int level = chain.Select(pixels, previous);
+	state.version = version;
+	state.level = static_cast<uint8_t>(level);
+	return chain.meshes[level];
+}
+
+InstancedRenderer::Batch& InstancedRenderer::FindBatch(Mesh* mesh, uint32_t batch_program)
+{
+	//objects of one mesh usually come in runs, so the previous batch is checked first
+	if (last_batch < batches.size() && batches[last_batch].mesh == mesh && batches[last_batch].program == batch_program)
+		return batches[last_batch];
+
+	for (size_t i = 0; i < batches.size(); i++)
+	{
+		if (batches[i].mesh == mesh && batches[i].program == batch_program)
+		{
+			last_batch = i;
+			return batches[i];
+		}
+	}
+
+	batches.emplace_back();
+	batches.back().mesh = mesh;
+	batches.back().program = batch_program;
+	last_batch = batches.size() - 1;
+	return batches.back();
+}
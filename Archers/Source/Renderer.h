@@ -0,0 +1,164 @@
+#pragma once
+#include "StreamBuffer.h"
+#include "Culling.h"
+#include "RenderQueue.h"
+#include "GpuCulling.h"
+
+//per-instance vertex attributes, locations 2 to 5 of the vertex shader
+struct InstanceData
+{
+	//orientation quaternion as x, y, z, w
+	glm::vec4 rotation;
+	glm::vec3 position;
+	glm::vec3 scale;
+	glm::vec3 color;
+};
+
+//collects the objects of a frame grouped by mesh and draws every group with a single instanced call,
+//instance and camera data go through the stream buffer and draws through the sorted render queue
+class InstancedRenderer
+{
+public:
+	InstancedRenderer(RenderBackend& render_backend, StreamBuffer& frame_stream);
+
+	InstancedRenderer(const InstancedRenderer&) = delete;
+	InstancedRenderer& operator=(const InstancedRenderer&) = delete;
+
+	//drops the instances of the previous frame, meshes stay registered so their storage is reused
+	void Begin();
+	//program the instances added from now on are drawn with, instances of one mesh under different programs get separate draws
+	void SetProgram(uint32_t shader_program)
+	{
+		program = shader_program;
+	}
+	//program for the meshes with packed vertices, the PACKED_VERTEX variant of the one set with SetProgram
+	void SetPackedProgram(uint32_t shader_program)
+	{
+		packed_program = shader_program;
+	}
+	//camera uniform block, binding 0, instances outside of its frustum aren't drawn
+	void SetCamera(const glm::mat4& projection, const glm::mat4& view);
+	//framebuffer height in pixels, levels of detail are picked by projected size
+	void SetViewportHeight(int height)
+	{
+		viewport_height = static_cast<float>(height);
+	}
+	//everything is drawn while culling is off
+	void SetCulling(bool enable)
+	{
+		culling = enable;
+	}
+	//culls in a compute shader and draws with one multi draw indirect per program and vertex format,
+	//falls back to the CPU path while no cull program is set
+	void SetGpuCulling(bool enable)
+	{
+		gpu_culling = enable;
+	}
+	void SetCullProgram(uint32_t compute_program)
+	{
+		gpu_culler.SetProgram(compute_program);
+	}
+	bool GpuCulling() const
+	{
+		return gpu_culling && gpu_culler.Available();
+	}
+	//meshes with a LOD chain are drawn at every level of it with the finest one used everywhere while off
+	void SetLod(bool enable)
+	{
+		lod = enable;
+	}
+	//object identifies the instance across frames so its level of detail doesn't flicker at a threshold,
+	//an object seen with a new version is a different one that reuses the index
+	void Add(Mesh* mesh, glm::vec3 position, glm::quat rotation, glm::vec3 scale, glm::vec3 color, uint32_t object = no_object, uint32_t version = 0);
+	//writes all instances at once and issues one draw per mesh
+	void Draw();
+	//reads back the last GPU culled frame, compares every draw with FrustumCuller and fills in the visible counts
+	//the GPU path can't know without waiting for it
+	GpuCullCheck VerifyGpuCulling();
+
+	size_t DrawCalls() const
+	{
+		return draw_calls;
+	}
+
+	//instances drawn in the last frame
+	size_t Instances() const
+	{
+		return instance_count;
+	}
+
+	//triangles of the instances drawn in the last frame
+	size_t Triangles() const
+	{
+		return triangle_count;
+	}
+
+	const CullStats& Culling() const
+	{
+		return cull_stats;
+	}
+
+	//state changes of the current frame, asked for by the draws and left after skipping redundant ones
+	const GLStateCache& State() const
+	{
+		return state;
+	}
+
+	static const uint32_t no_object = 0xFFFFFFFF;
+
+private:
+	struct Batch
+	{
+		Mesh* mesh = nullptr;
+		uint32_t program = 0;
+		std::vector<InstanceData> instances;
+		//world space bounds of the instances
+		SphereSet spheres;
+		std::vector<uint32_t> visible;
+	};
+
+	Batch& FindBatch(Mesh* mesh, uint32_t batch_program);
+	void DrawIndirect();
+	Mesh* SelectLod(Mesh* mesh, glm::vec3 center, float radius, uint32_t object, uint32_t version);
+
+	RenderBackend& backend;
+	StreamBuffer& stream;
+	size_t uniform_alignment = 256;
+	size_t storage_alignment = 256;
+	uint32_t program = 0;
+	uint32_t packed_program = 0;
+	RenderQueue queue;
+	GLStateCache state;
+	glm::mat4 view_matrix = glm::mat4(1.f);
+	Frustum frustum;
+	bool culling = true;
+	bool has_camera = false;
+	bool lod = true;
+	bool gpu_culling = false;
+	//clip space w of a point is its dot product with this row of the view projection
+	glm::vec4 clip_w_row = glm::vec4(0.f, 0.f, 0.f, 1.f);
+	float projection_scale = 1.f;
+	float viewport_height = 720.f;
+	struct ObjectLod
+	{
+		uint32_t version;
+		uint8_t level;
+	};
+
+	//level each object was drawn at last and the version it was drawn for, indexed by object, 0xFF when unknown
+	std::vector<ObjectLod> object_lods;
+
+	std::vector<Batch> batches;
+	size_t last_batch = 0;
+
+	GpuCuller gpu_culler;
+	//batches in the order of their indirect commands and the commands before culling
+	std::vector<size_t> indirect_batches;
+	std::vector<DrawElementsIndirectCommand> indirect_commands;
+	bool indirect_culled = false;
+
+	size_t draw_calls = 0;
+	size_t instance_count = 0;
+	size_t triangle_count = 0;
+	CullStats cull_stats;
+};
@@ -0,0 +1,95 @@
+#pragma once
+#include <cstdint>
+
+//simulation time, advances only in whole fixed-length ticks so every run of the same battle steps identically
+//real time is fed in scaled (slow-mo, fast-forward) or ignored while paused, batch runs just Step() in a loop
+class SimClock
+{
+public:
+	SimClock(double ticks_per_second = 20.0)
+	{
+		SetTickRate(ticks_per_second);
+	}
+
+	void SetTickRate(double ticks_per_second)
+	{
+		tick_length = 1.0 / ticks_per_second;
+	}
+
+	//feed real elapsed seconds, ticks that became due are taken with ConsumeTick
+	void Accumulate(double real_seconds)
+	{
+		if (!paused)
+		{
+			accumulator += real_seconds * scale;
+		}
+	}
+
+	//advances by one tick if enough time was accumulated
+	bool ConsumeTick()
+	{
+		if (accumulator < tick_length)
+			return false;
+
+		accumulator -= tick_length;
+		Step();
+		return true;
+	}
+
+	//advances by one tick unconditionally
+	void Step()
+	{
+		ticks++;
+		now += tick_length;
+	}
+
+	//time of the current tick
+	double Now() const
+	{
+		return now;
+	}
+
+	double TickLength() const
+	{
+		return tick_length;
+	}
+
+	uint64_t Ticks() const
+	{
+		return ticks;
+	}
+
+	//fraction of a tick accumulated but not yet simulated
+	double Alpha() const
+	{
+		return accumulator / tick_length;
+	}
+
+	void SetScale(double time_scale)
+	{
+		scale = time_scale;
+	}
+
+	double Scale() const
+	{
+		return scale;
+	}
+
+	void SetPaused(bool pause)
+	{
+		paused = pause;
+	}
+
+	bool IsPaused() const
+	{
+		return paused;
+	}
+
+private:
+	double tick_length;
+	double now = 0.0;
+	double accumulator = 0.0;
+	double scale = 1.0;
+	bool paused = false;
+	uint64_t ticks = 0;
+};
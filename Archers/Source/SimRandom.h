@@ -0,0 +1,50 @@
+#pragma once
+#include <cstdint>
+#include <entt.hpp>
+
+//what a random draw is used for, each use gets its own stream so draws never shift one another
+enum class RandomStream : uint32_t
+{
+	SpawnSpreadX,
+	SpawnSpreadZ,
+	SpawnVelocityX,
+	SpawnVelocityZ,
+	AvoidX,
+	AvoidZ,
+	ArcChoice
+};
+
+//counter-based random numbers, a draw is a pure function of the battle seed, the entity, the tick and the stream
+//so it doesn't matter in which order or on how many threads the systems run, the same battle replays bit for bit
+class SimRandom
+{
+public:
+	SimRandom(uint64_t battle_seed = 0)
+	{
+		seed = Mix(battle_seed);
+	}
+
+	uint64_t Bits(entt::entity entity, uint64_t tick, RandomStream stream) const
+	{
+		uint64_t key = seed ^ Mix(static_cast<uint64_t>(entt::to_integral(entity)) << 32 | static_cast<uint32_t>(stream));
+		return Mix(key ^ Mix(tick));
+	}
+
+	//uniform in [0, 1)
+	float Uniform(entt::entity entity, uint64_t tick, RandomStream stream) const
+	{
+		return (Bits(entity, tick, stream) >> 40) * (1.f / 16777216.f);
+	}
+
+private:
+	//SplitMix64 finalizer
+	static uint64_t Mix(uint64_t x)
+	{
+		x += 0x9E3779B97F4A7C15ull;
+		x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+		x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+		return x ^ (x >> 31);
+	}
+
+	uint64_t seed;
+};
@@ -0,0 +1,340 @@
+#include "Simulation.h"
+#include "Hash.h"
+#include "Profiler.h"
+
+Simulation::Simulation(const SimulationSettings& sim_settings) : rng(sim_settings.seed)
+{
+	settings = sim_settings;
+}
+
+void Simulation::SetMeshes(Mesh* archer, Mesh* arrow)
+{
+	archer_mesh = archer;
+	arrow_mesh = arrow;
+}
+
+void Simulation::Step()
+{
+	clock.Step();
+	UpdateSimulation();
+}
+
+//update objects on scene
+void Simulation::UpdateSimulation()
+{
+	PROFILE_ZONE("UpdateSimulation");
+	//the clock is read once, every system of this tick sees the same time
+	double now = clock.Now();
+	float dt = static_cast<float>(clock.TickLength());
+
+	SpawnArchers();
+	SavePrevTransforms();
+	MoveObjects(dt);
+	//archers are binned once per tick, projectiles only test the cells around them
+	BuildArcherGrids();
+	UpdateProjectiles(now);
+	UpdateArchers(now);
+}
+
+void Simulation::SpawnArchers()
+{
+	PROFILE_ZONE("SpawnArchers");
+
+	if (archers_count >= settings.archer_count || clock.Ticks() % 2 == 0)
+		return;
+
+	for (int i = 0; i < settings.spawn_batch && archers_count < settings.archer_count; i++)
+	{
+		archers_count += 2;
+		SpawnArcher(true);
+		SpawnArcher(false);
+	}
+}
+
+//remember where moving objects were, frames are drawn in between
+void Simulation::SavePrevTransforms()
+{
+	PROFILE_ZONE("SavePrevTransforms");
+
+	for (auto object : ent_registry.view<PrevTransform>())
+	{
+		PrevTransform& prev = ent_registry.get<PrevTransform>(object);
+		prev.pos = ent_registry.get<Position>(object).coord;
+		prev.ori = ent_registry.get<Orientation>(object).ori;
+	}
+}
+
+//move objects according to their linear velocity
+void Simulation::MoveObjects(float dt)
+{
+	PROFILE_ZONE("MoveObjects");
+
+	float wall = settings.field_extent;
+
+	for (auto object : ent_registry.view<Velocity>())
+	{
+		glm::vec3 new_pos = ent_registry.get<Position>(object).coord + ent_registry.get<Velocity>(object).vel * dt;
+		if (new_pos.x >= wall || new_pos.x <= -wall)
+		{
+			ent_registry.get<Velocity>(object).vel.x *= -1.f;
+			new_pos = ent_registry.get<Position>(object).coord + ent_registry.get<Velocity>(object).vel * dt;
+		}
+		if (new_pos.z >= wall || new_pos.z <= -wall)
+		{
+			ent_registry.get<Velocity>(object).vel.z *= -1.f;
+			new_pos = ent_registry.get<Position>(object).coord + ent_registry.get<Velocity>(object).vel * dt;
+		}
+
+		ent_registry.get<Position>(object).coord = new_pos;
+	}
+}
+
+//bin archers of each team into their grid
+void Simulation::BuildArcherGrids()
+{
+	PROFILE_ZONE("BuildArcherGrids");
+
+	red_grid.Clear();
+	blue_grid.Clear();
+	for (auto object : ent_registry.view<Archer>())
+	{
+		SpatialGrid& team_grid = ent_registry.get<Archer>(object).IsRed() ? red_grid : blue_grid;
+		team_grid.Insert(object, ent_registry.get<Position>(object).coord);
+	}
+	red_grid.Build();
+	blue_grid.Build();
+}
+
+//update projectile trajectories
+void Simulation::UpdateProjectiles(double now)
+{
+	PROFILE_ZONE("UpdateProjectiles");
+
+	bool archers_killed = false;
+
+	for (auto object : ent_registry.view<Trajectory>())
+	{
+		Trajectory& project_traj = ent_registry.get<Trajectory>(object);
+		double prev_time = project_traj.Elapsed();
+		project_traj.UpdatePosition(ent_registry.get<Position>(object), ent_registry.get<Orientation>(object), now);
+		glm::vec3 arrow_pos = ent_registry.get<Position>(object).coord;
+		//the whole path since the last tick is swept, so large steps don't tunnel through archers
+		entt::entity archR = SweepProjectile(project_traj, prev_time, project_traj.Elapsed());
+
+		if (archR != entt::null)
+		{
+			ent_registry.get<Health>(archR).Hit(20);
+			ent_registry.destroy(object);
+
+			if (ent_registry.get<Health>(archR).IsGreaterThanZero() == false)
+			{
+				ent_registry.destroy(archR);
+				archers_killed = true;
+			}
+		}
+		else if (arrow_pos.y <= 0.f)
+		{
+			ent_registry.destroy(object);
+		}
+	}
+	ent_registry.compact();
+
+	if (archers_killed)
+	{
+		BuildArcherGrids();
+	}
+}
+
+//update archers behaviours
+void Simulation::UpdateArchers(double now)
+{
+	PROFILE_ZONE("UpdateArchers");
+
+	for (auto object : ent_registry.view<Archer>())
+	{
+		glm::vec3 pos = ent_registry.get<Position>(object).coord;
+		bool is_red = ent_registry.get<Archer>(object).IsRed();
+		//only neighbouring cells are checked for allies, the nearest foe comes from the foe grid's k-d tree
+		ArcherTarget target = AcquireTarget(is_red ? red_grid : blue_grid, is_red ? blue_grid : red_grid, object, pos, 3.4f);
+		//archer's state
+		if (target.entity != entt::null && target.distance != 0.f)
+		{
+			glm::vec3 dir = glm::normalize(glm::vec3(ent_registry.get<Position>(target.entity).coord - pos));
+			//friendly collision is top priority
+			if (target.distance == -1 && glm::dot(ent_registry.get<Velocity>(object).vel, dir) >= 0)
+			{
+				//move in perpendicular direction from ally
+				glm::vec3 swerve = glm::vec3(-0.1f - rng.Uniform(object, clock.Ticks(), RandomStream::AvoidX), 0.f, -0.1f - rng.Uniform(object, clock.Ticks(), RandomStream::AvoidZ));
+				ent_registry.get<Velocity>(object) = archer_speed * glm::cross(glm::vec3(0.f, 1.f, 0.f), swerve * dir);
+			}
+			else if (target.distance > 40.f)
+			{
+				//move closer to foe
+				ent_registry.get<Velocity>(object) = archer_speed * glm::vec3(1.f, 0.f, 1.f) * dir;
+			}
+			else if (target.distance > 0 && target.distance <= 40.f && ent_registry.get<Archer>(object).CanShoot(now))
+			{
+				//enemy is close enough, shoot
+				ent_registry.get<Velocity>(object) = glm::vec3(0.f, 0.f, 0.f);
+				ShootProjectile(object, ent_registry.get<Position>(target.entity).coord, now);
+			}
+			else if (target.distance > 0)
+			{
+				ent_registry.get<Velocity>(object) = glm::vec3(0.f, 0.f, 0.f);
+			}
+		}
+	}
+}
+
+int Simulation::ArchersLeft(bool red)
+{
+	int count = 0;
+
+	for (auto object : ent_registry.view<Archer>())
+	{
+		if (ent_registry.get<Archer>(object).IsRed() == red)
+			count++;
+	}
+
+	return count;
+}
+
+uint64_t Simulation::StateHash()
+{
+	//FNV-1a over the raw component bytes
+	uint64_t hash = fnv1a_basis;
+	auto add = [&hash](const void* data, size_t size)
+	{
+		hash = Fnv1a(data, size, hash);
+	};
+
+	for (auto object : ent_registry.view<Archer>())
+	{
+		add(&ent_registry.get<Position>(object).coord, sizeof(glm::vec3));
+		add(&ent_registry.get<Velocity>(object).vel, sizeof(glm::vec3));
+		add(&ent_registry.get<Health>(object), sizeof(Health));
+	}
+	for (auto object : ent_registry.view<Trajectory>())
+	{
+		add(&ent_registry.get<Position>(object).coord, sizeof(glm::vec3));
+	}
+
+	return hash;
+}
+
+//red team comes from the -X-Z corner, blue from the opposite one
+void Simulation::SpawnArcher(bool red)
+{
+	float side = red ? -1.f : 1.f;
+	//the spread square is kept inside the walls, archers outside would keep bouncing off them the wrong way
+	float corner = side * (settings.field_extent - 8.f - settings.spawn_spread);
+	glm::vec3 spawn_point = glm::vec3(corner, 2.5f, corner);
+	entt::entity entity = ent_registry.create();
+	uint64_t tick = clock.Ticks();
+
+	if (settings.spawn_spread > 0.f)
+	{
+		spawn_point.x += settings.spawn_spread * (2.f * rng.Uniform(entity, tick, RandomStream::SpawnSpreadX) - 1.f);
+		spawn_point.z += settings.spawn_spread * (2.f * rng.Uniform(entity, tick, RandomStream::SpawnSpreadZ) - 1.f);
+	}
+
+	ent_registry.emplace<Position>(entity, spawn_point);
+	ent_registry.emplace<Orientation>(entity, glm::angleAxis(0.f, glm::vec3(0, 1, 0)));
+	if (archer_mesh != nullptr)
+	{
+		ent_registry.emplace<MeshComponent>(entity, archer_mesh, glm::vec3(1.f), red ? glm::vec3(1.f, 0.f, 0.f) : glm::vec3(0.f, 0.f, 1.f));
+	}
+	ent_registry.emplace<Archer>(entity, Archer(red));
+	ent_registry.emplace<Health>(entity);
+	ent_registry.emplace<Velocity>(entity, -side * archer_speed * glm::vec3(0.1f + rng.Uniform(entity, tick, RandomStream::SpawnVelocityX), 0.f, 0.1f + rng.Uniform(entity, tick, RandomStream::SpawnVelocityZ)));
+	ent_registry.emplace<PrevTransform>(entity, ent_registry.get<Position>(entity).coord, ent_registry.get<Orientation>(entity).ori);
+}
+
+//projectile is shot from archer's head to the target's position
+void Simulation::ShootProjectile(entt::entity archer, glm::vec3 target, double now)
+{
+	if (ent_registry.try_get<Archer>(archer) != nullptr)
+	{
+		glm::vec3 pos = ent_registry.get<Position>(archer) + glm::vec3(0.f, 1.7f, 0.f);
+		entt::entity projectile = ent_registry.create();
+		bool high_arc = rng.Bits(archer, clock.Ticks(), RandomStream::ArcChoice) & 1;
+		Trajectory prj_trj(pos, target, 40, now, high_arc, archer);
+		glm::quat q = glm::quatLookAt(glm::normalize(target - pos), glm::vec3(0.f, 1.f, 0.f));
+
+		ent_registry.emplace<Position>(projectile, glm::vec3(pos));
+		ent_registry.emplace<Orientation>(projectile, q);
+		ent_registry.emplace<Trajectory>(projectile, prj_trj);
+		ent_registry.emplace<PrevTransform>(projectile, pos, q);
+		if (arrow_mesh != nullptr)
+		{
+			ent_registry.emplace<MeshComponent>(projectile, arrow_mesh, glm::vec3(1.f), glm::vec3(0.f));
+		}
+		ent_registry.get<Archer>(archer).Reload(now);
+	}
+}
+
+//first archer hit by the arrow between two moments of its flight, the arc is split into chords short
+//enough to stay within a few centimeters of the parabola and only the part above ground is tested
+entt::entity Simulation::SweepProjectile(const Trajectory& trajectory, double from, double to)
+{
+	const double max_chord_time = 0.2;
+	int chords = glm::max(1, static_cast<int>(glm::ceil((to - from) / max_chord_time)));
+	glm::vec3 a = trajectory.PositionAt(from);
+
+	for (int i = 1; i <= chords && a.y > 0.f; i++)
+	{
+		glm::vec3 b = trajectory.PositionAt(from + (to - from) * i / chords);
+		entt::entity hit = entt::null;
+		float hit_t = 2.f;
+		auto test_hit = [&](const GridEntry& candidate, float t)
+		{
+			//archers killed earlier this tick are still in the grids
+			if (t < hit_t && candidate.entity != trajectory.Owner() && ent_registry.valid(candidate.entity))
+			{
+				hit_t = t;
+				hit = candidate.entity;
+			}
+		};
+		red_grid.QuerySegment(a, b, 1.7f, test_hit);
+		blue_grid.QuerySegment(a, b, 1.7f, test_hit);
+
+		if (hit != entt::null)
+			return hit;
+
+		a = b;
+	}
+
+	return entt::null;
+}
+
+void Simulation::WriteSnapshot(RenderSnapshot& snapshot)
+{
+	PROFILE_ZONE("WriteSnapshot");
+
+	snapshot.objects.clear();
+	snapshot.tick = clock.Ticks();
+	snapshot.tick_length = clock.TickLength();
+
+	for (auto object : ent_registry.view<MeshComponent>(entt::exclude<StaticMesh>))
+	{
+		MeshComponent& object_mesh = ent_registry.get<MeshComponent>(object);
+		SnapshotObject entry;
+		entry.mesh = object_mesh.get();
+		entry.object = entt::to_entity(object);
+		entry.version = entt::to_version(object);
+		entry.position = ent_registry.get<Position>(object).coord;
+		entry.rotation = ent_registry.get<Orientation>(object).ori;
+		entry.prev_position = entry.position;
+		entry.prev_rotation = entry.rotation;
+		entry.scale = object_mesh.scale();
+		entry.color = object_mesh.color();
+
+		if (PrevTransform* prev = ent_registry.try_get<PrevTransform>(object))
+		{
+			entry.prev_position = prev->pos;
+			entry.prev_rotation = prev->ori;
+		}
+
+		snapshot.objects.push_back(entry);
+	}
+}
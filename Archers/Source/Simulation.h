@@ -0,0 +1,98 @@
+#pragma once
+#include "EntityComponents.h"
+#include "SpatialGrid.h"
+#include "SimClock.h"
+#include "SimRandom.h"
+#include "RenderSnapshot.h"
+
+struct SimulationSettings
+{
+	//archers of both teams spawned over the battle
+	int archer_count = 40;
+	//pairs of archers spawned every other tick
+	int spawn_batch = 1;
+	//walls are at +-field_extent on X and Z, teams spawn in opposite corners 8 units away from the walls
+	float field_extent = 48.f;
+	//archers are scattered over a square of this half size in their team's corner
+	float spawn_spread = 0.f;
+	uint32_t seed = 0;
+
+	//a battle of archer_count archers at the density of the default 40 archer one, the field grows with
+	//the count and everyone is spawned on the first tick, spread around the team corners
+	static SimulationSettings Scaled(int archer_count, uint32_t seed = 0)
+	{
+		SimulationSettings settings;
+		settings.archer_count = archer_count;
+		settings.seed = seed;
+		settings.field_extent = glm::max(48.f, 48.f * glm::sqrt(archer_count / 40.f));
+		settings.spawn_batch = (archer_count + 1) / 2;
+		settings.spawn_spread = settings.field_extent / 4.f;
+		return settings;
+	}
+};
+
+//battle state and systems, no window or GL context is needed to run it
+class Simulation
+{
+public:
+	Simulation(const SimulationSettings& sim_settings = SimulationSettings());
+
+	//meshes given to spawned archers and arrows, headless runs leave them unset
+	void SetMeshes(Mesh* archer, Mesh* arrow);
+
+	//simulate the tick the clock is at
+	void UpdateSimulation();
+	//advance the clock by one tick and simulate it, for runs that don't follow real time
+	void Step();
+
+	//passes of UpdateSimulation in the order they run
+	void SpawnArchers();
+	void SavePrevTransforms();
+	void MoveObjects(float dt);
+	void BuildArcherGrids();
+	void UpdateProjectiles(double now);
+	void UpdateArchers(double now);
+
+	//first archer hit by the arrow between two moments of its flight, tests the grids of the last BuildArcherGrids
+	entt::entity SweepProjectile(const Trajectory& trajectory, double from, double to);
+
+	//copies the moving objects of the current tick, the render thread draws from the copy while the next tick runs
+	void WriteSnapshot(RenderSnapshot& snapshot);
+
+	int ArchersLeft(bool red);
+	//hash of every archer's and arrow's state, equal hashes mean two runs played out the same battle
+	uint64_t StateHash();
+
+	entt::registry& Registry()
+	{
+		return ent_registry;
+	}
+
+	SimClock& Clock()
+	{
+		return clock;
+	}
+
+	const SimulationSettings& Settings() const
+	{
+		return settings;
+	}
+
+private:
+	void SpawnArcher(bool red);
+	void ShootProjectile(entt::entity archer, glm::vec3 target, double now);
+
+	SimulationSettings settings;
+	entt::registry ent_registry;
+	SimClock clock;
+	SimRandom rng;
+	//archers of each team, rebuilt every tick
+	SpatialGrid red_grid;
+	SpatialGrid blue_grid;
+
+	Mesh* archer_mesh = nullptr;
+	Mesh* arrow_mesh = nullptr;
+	int archers_count = 0;
+	//archers used to cover up to one unit per 50ms frame
+	const float archer_speed = 20.f;
+};
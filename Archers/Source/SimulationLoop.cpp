@@ -0,0 +1,87 @@
+#include "SimulationLoop.h"
+#include <chrono>
+#include "Profiler.h"
+
+SimulationLoop::SimulationLoop(Simulation& loop_simulation, SnapshotBuffer& loop_snapshots, double (*time_source)())
+	: simulation(loop_simulation), snapshots(loop_snapshots), now(time_source)
+{
+}
+
+SimulationLoop::~SimulationLoop()
+{
+	Stop();
+}
+
+int SimulationLoop::Advance()
+{
+	PROFILE_ZONE("Simulation");
+	SimClock& clock = simulation.Clock();
+	double time = now();
+	if (last_time < 0.0)
+		last_time = time;
+
+	bool was_paused = clock.IsPaused();
+	double old_scale = clock.Scale();
+	clock.SetPaused(paused);
+	clock.SetScale(scale);
+
+	//a long stall (window drag, breakpoint) shouldn't be caught up tick by tick
+	clock.Accumulate(glm::min(time - last_time, 0.25));
+	last_time = time;
+
+	int ticks = 0;
+	while (clock.ConsumeTick())
+	{
+		simulation.UpdateSimulation();
+		ticks++;
+	}
+
+	//a snapshot keeps being interpolated from until the next one, a pause or speed change has to reach it too
+	bool controls_changed = was_paused != clock.IsPaused() || old_scale != clock.Scale();
+	if (ticks > 0 || controls_changed || published == false)
+	{
+		RenderSnapshot& snapshot = snapshots.WriteBuffer();
+		simulation.WriteSnapshot(snapshot);
+		snapshot.published = time;
+		snapshot.published_alpha = clock.Alpha();
+		snapshot.rate = clock.IsPaused() ? 0.0 : clock.Scale();
+		snapshots.Publish();
+		published = true;
+	}
+
+	return ticks;
+}
+
+void SimulationLoop::Start()
+{
+	if (thread.joinable())
+		return;
+
+	running = true;
+	thread = std::thread(&SimulationLoop::Run, this);
+}
+
+void SimulationLoop::Stop()
+{
+	running = false;
+	if (thread.joinable())
+		thread.join();
+}
+
+void SimulationLoop::Run()
+{
+	Profiler::SetThreadName("Simulation");
+
+	while (running)
+	{
+		Advance();
+
+		//sleep until the next tick is due, at most 5ms so controls and Stop are picked up quickly
+		SimClock& clock = simulation.Clock();
+		double wait = 0.005;
+		if (clock.IsPaused() == false)
+			wait = glm::min(wait, (1.0 - clock.Alpha()) * clock.TickLength() / clock.Scale());
+
+		std::this_thread::sleep_for(std::chrono::duration<double>(glm::max(wait, 0.0)));
+	}
+}
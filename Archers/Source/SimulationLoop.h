@@ -0,0 +1,63 @@
+#pragma once
+#include <atomic>
+#include <thread>
+#include "Simulation.h"
+
+//follows real time with the simulation and publishes a render snapshot after the ticks that became due,
+//either from the render loop through Advance or on a thread of its own between Start and Stop
+class SimulationLoop
+{
+public:
+	//time_source gives seconds on the clock the snapshots are stamped with, the render thread reads the same one
+	SimulationLoop(Simulation& loop_simulation, SnapshotBuffer& loop_snapshots, double (*time_source)());
+	~SimulationLoop();
+
+	SimulationLoop(const SimulationLoop&) = delete;
+	SimulationLoop& operator=(const SimulationLoop&) = delete;
+
+	//catches the simulation up with the time source, returns the ticks simulated
+	int Advance();
+	//runs Advance on the simulation thread until Stop, the simulation must not be touched by anyone else meanwhile
+	void Start();
+	void Stop();
+
+	bool IsThreaded() const
+	{
+		return thread.joinable();
+	}
+
+	//controls are picked up by the next Advance, safe to call from any thread
+	void SetPaused(bool pause)
+	{
+		paused = pause;
+	}
+
+	bool IsPaused() const
+	{
+		return paused;
+	}
+
+	void SetScale(double time_scale)
+	{
+		scale = time_scale;
+	}
+
+	double Scale() const
+	{
+		return scale;
+	}
+
+private:
+	void Run();
+
+	Simulation& simulation;
+	SnapshotBuffer& snapshots;
+	double (*now)();
+	double last_time = -1.0;
+	bool published = false;
+
+	std::thread thread;
+	std::atomic<bool> running{ false };
+	std::atomic<bool> paused{ false };
+	std::atomic<double> scale{ 1.0 };
+};
@@ -0,0 +1,438 @@
+#include "SoftwareRasterizer.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include "FileManager.h"
+#include "Profiler.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define RASTER_LANES 4
+#else
+#define RASTER_LANES 1
+#endif
+
+//instances are split so that a chunk sets up about this many triangles, enough to keep every thread busy
+static const size_t chunk_triangles = 8192;
+
+static double Seconds(std::chrono::steady_clock::time_point start)
+{
+	return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+static uint32_t PackColor(glm::vec3 rgb)
+{
+	//GL rounds to the nearest unorm8
+	glm::uvec3 bytes = glm::uvec3(glm::clamp(rgb, 0.f, 1.f) * 255.f + 0.5f);
+	return bytes.r | bytes.g << 8 | bytes.b << 16 | 0xFFu << 24;
+}
+
+SoftwareRasterizer::SoftwareRasterizer(int width, int height, int threads)
+{
+	Resize(width, height);
+
+	if (threads <= 0)
+		threads = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+
+	for (int i = 1; i < threads; i++)
+	{
+		workers.push_back(std::thread(&SoftwareRasterizer::WorkerLoop, this));
+	}
+}
+
+SoftwareRasterizer::~SoftwareRasterizer()
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		stopping = true;
+	}
+	wake.notify_all();
+
+	for (std::thread& worker : workers)
+	{
+		worker.join();
+	}
+}
+
+void SoftwareRasterizer::Resize(int new_width, int new_height)
+{
+	width = std::max(new_width, 1);
+	height = std::max(new_height, 1);
+	stride = (width + 3) & ~3;
+	tiles_x = (width + tile_size - 1) / tile_size;
+	tiles_y = (height + tile_size - 1) / tile_size;
+	color.assign(static_cast<size_t>(stride) * height, 0);
+	depth.assign(static_cast<size_t>(stride) * height, 1.f);
+
+	//bins are sized for the old tile count
+	chunks.clear();
+}
+
+void SoftwareRasterizer::Begin(const glm::mat4& projection, const glm::mat4& view, glm::vec3 clear_color)
+{
+	view_projection = projection * view;
+	clear_rgba = PackColor(clear_color);
+	draws.clear();
+}
+
+void SoftwareRasterizer::Draw(const Vertex* vertices, size_t vertex_count, const uint32_t* indices, size_t index_count, const RasterInstance* instances,
+	size_t instance_count)
+{
+	if (index_count < 3 || instance_count == 0)
+		return;
+
+	draws.push_back({ vertices, vertex_count, indices, index_count, instances, instance_count });
+}
+
+void SoftwareRasterizer::End()
+{
+	PROFILE_ZONE("SoftwareRaster");
+
+	stats = RasterStats();
+	auto start = std::chrono::steady_clock::now();
+
+	//the same split for any number of threads, so tiles see triangles in the same order
+	used_chunks = 0;
+	for (size_t d = 0; d < draws.size(); d++)
+	{
+		size_t per_chunk = std::max<size_t>(1, chunk_triangles / (draws[d].index_count / 3));
+		for (size_t first = 0; first < draws[d].instance_count; first += per_chunk)
+		{
+			if (used_chunks == chunks.size())
+				chunks.push_back(Chunk());
+
+			Chunk& chunk = chunks[used_chunks++];
+			chunk.draw = d;
+			chunk.first_instance = first;
+			chunk.instance_count = std::min(per_chunk, draws[d].instance_count - first);
+		}
+	}
+
+	ParallelFor(used_chunks, [this](size_t i)
+	{
+		SetupChunk(chunks[i]);
+	});
+
+	for (size_t i = 0; i < used_chunks; i++)
+	{
+		stats.triangles += chunks[i].triangles.size();
+		for (const std::vector<uint32_t>& bin : chunks[i].bins)
+		{
+			stats.binned += bin.size();
+		}
+	}
+	stats.setup_seconds = Seconds(start);
+	start = std::chrono::steady_clock::now();
+
+	ParallelFor(static_cast<size_t>(tiles_x) * tiles_y, [this](size_t tile)
+	{
+		RasterizeTile(static_cast<int>(tile));
+	});
+
+	stats.raster_seconds = Seconds(start);
+	draws.clear();
+}
+
+void SoftwareRasterizer::SetupChunk(Chunk& chunk)
+{
+	const DrawCall& draw = draws[chunk.draw];
+	chunk.vertices.clear();
+	chunk.triangles.clear();
+	chunk.bins.resize(static_cast<size_t>(tiles_x) * tiles_y);
+	for (std::vector<uint32_t>& bin : chunk.bins)
+	{
+		bin.clear();
+	}
+
+	for (size_t i = 0; i < chunk.instance_count; i++)
+	{
+		const RasterInstance& instance = draw.instances[chunk.first_instance + i];
+		uint32_t base = static_cast<uint32_t>(chunk.vertices.size());
+
+		//same as default.vert, the normal is rotated but not scaled
+		for (size_t v = 0; v < draw.vertex_count; v++)
+		{
+			ScreenVertex out;
+			out.world = instance.position + instance.rotation * (instance.scale * draw.vertices[v].pos);
+			out.normal = instance.rotation * draw.vertices[v].normal;
+
+			glm::vec4 clip = view_projection * glm::vec4(out.world, 1.f);
+			//behind the eye, triangles using it are dropped instead of clipped
+			out.inv_w = clip.w > 0.f ? 1.f / clip.w : 0.f;
+			out.x = (clip.x * out.inv_w * 0.5f + 0.5f) * width;
+			out.y = (0.5f - clip.y * out.inv_w * 0.5f) * height;
+			out.z = clip.z * out.inv_w * 0.5f + 0.5f;
+			chunk.vertices.push_back(out);
+		}
+
+		for (size_t t = 0; t + 2 < draw.index_count; t += 3)
+		{
+			ScreenTriangle triangle = { { base + draw.indices[t], base + draw.indices[t + 1], base + draw.indices[t + 2] }, instance.color };
+			const ScreenVertex* a = &chunk.vertices[triangle.v[0]];
+			const ScreenVertex* b = &chunk.vertices[triangle.v[1]];
+			const ScreenVertex* c = &chunk.vertices[triangle.v[2]];
+			if (a->inv_w == 0.f || b->inv_w == 0.f || c->inv_w == 0.f)
+				continue;
+			if ((a->z < 0.f && b->z < 0.f && c->z < 0.f) || (a->z > 1.f && b->z > 1.f && c->z > 1.f))
+				continue;
+
+			float area = (b->x - a->x) * (c->y - a->y) - (b->y - a->y) * (c->x - a->x);
+			if (area == 0.f)
+				continue;
+			if (area < 0.f)
+				std::swap(triangle.v[1], triangle.v[2]);
+
+			//pixels whose centers fall within the bounds
+			int x0 = std::max(0, static_cast<int>(std::ceil(std::min({ a->x, b->x, c->x }) - 0.5f)));
+			int x1 = std::min(width - 1, static_cast<int>(std::floor(std::max({ a->x, b->x, c->x }) - 0.5f)));
+			int y0 = std::max(0, static_cast<int>(std::ceil(std::min({ a->y, b->y, c->y }) - 0.5f)));
+			int y1 = std::min(height - 1, static_cast<int>(std::floor(std::max({ a->y, b->y, c->y }) - 0.5f)));
+			if (x0 > x1 || y0 > y1)
+				continue;
+
+			uint32_t index = static_cast<uint32_t>(chunk.triangles.size());
+			chunk.triangles.push_back(triangle);
+			for (int ty = y0 / tile_size; ty <= y1 / tile_size; ty++)
+			{
+				for (int tx = x0 / tile_size; tx <= x1 / tile_size; tx++)
+				{
+					chunk.bins[ty * tiles_x + tx].push_back(index);
+				}
+			}
+		}
+	}
+}
+
+void SoftwareRasterizer::RasterizeTile(int tile)
+{
+	int x0 = (tile % tiles_x) * tile_size;
+	int y0 = (tile / tiles_x) * tile_size;
+	int x1 = std::min(x0 + tile_size, width);
+	int y1 = std::min(y0 + tile_size, height);
+
+	for (int y = y0; y < y1; y++)
+	{
+		std::fill(color.begin() + static_cast<size_t>(y) * stride + x0, color.begin() + static_cast<size_t>(y) * stride + x1, clear_rgba);
+		std::fill(depth.begin() + static_cast<size_t>(y) * stride + x0, depth.begin() + static_cast<size_t>(y) * stride + x1, 1.f);
+	}
+
+	for (size_t i = 0; i < used_chunks; i++)
+	{
+		const Chunk& chunk = chunks[i];
+		for (uint32_t index : chunk.bins[tile])
+		{
+			const ScreenTriangle& triangle = chunk.triangles[index];
+			RasterizeTriangle(chunk.vertices[triangle.v[0]], chunk.vertices[triangle.v[1]], chunk.vertices[triangle.v[2]], triangle.color, x0, y0, x1, y1);
+		}
+	}
+}
+
+//edge functions are positive inside, each is 0 on the edge opposite its vertex and the triangle's doubled area at it,
+//so divided by the area they are the barycentric weights
+void SoftwareRasterizer::RasterizeTriangle(const ScreenVertex& a, const ScreenVertex& b, const ScreenVertex& c, glm::vec3 triangle_color,
+	int tile_x0, int tile_y0, int tile_x1, int tile_y1)
+{
+	int x0 = std::max(tile_x0, static_cast<int>(std::ceil(std::min({ a.x, b.x, c.x }) - 0.5f)));
+	int x1 = std::min(tile_x1 - 1, static_cast<int>(std::floor(std::max({ a.x, b.x, c.x }) - 0.5f)));
+	int y0 = std::max(tile_y0, static_cast<int>(std::ceil(std::min({ a.y, b.y, c.y }) - 0.5f)));
+	int y1 = std::min(tile_y1 - 1, static_cast<int>(std::floor(std::max({ a.y, b.y, c.y }) - 0.5f)));
+	if (x0 > x1 || y0 > y1)
+		return;
+
+	float inv_area = 1.f / ((b.x - a.x) * (c.y - a.y) - (b.y - a.y) * (c.x - a.x));
+	//E(x, y) = dx * (x - from.x) + dy * (y - from.y) for the edges b to c, c to a and a to b
+	float dx_a = b.y - c.y, dy_a = c.x - b.x;
+	float dx_b = c.y - a.y, dy_b = a.x - c.x;
+	float dx_c = a.y - b.y, dy_c = b.x - a.x;
+	float dz_b = b.z - a.z;
+	float dz_c = c.z - a.z;
+
+#if RASTER_LANES == 4
+	//groups of 4 start on a multiple of 4, which stays inside the tile and the padded row
+	int start_x = x0 & ~3;
+	const __m128 lane_centers = _mm_setr_ps(0.5f, 1.5f, 2.5f, 3.5f);
+	const __m128 zero = _mm_setzero_ps();
+	const __m128 one = _mm_set1_ps(1.f);
+	const __m128 first_center = _mm_set1_ps(x0 + 0.25f);
+	const __m128 last_center = _mm_set1_ps(x1 + 0.75f);
+	const __m128 step_a = _mm_set1_ps(dx_a), step_b = _mm_set1_ps(dx_b), step_c = _mm_set1_ps(dx_c);
+	const __m128 area_scale = _mm_set1_ps(inv_area);
+	const __m128 z_a = _mm_set1_ps(a.z), z_b = _mm_set1_ps(dz_b), z_c = _mm_set1_ps(dz_c);
+
+	for (int y = y0; y <= y1; y++)
+	{
+		float center_y = y + 0.5f;
+		__m128 row_a = _mm_set1_ps(dy_a * (center_y - b.y) - dx_a * b.x);
+		__m128 row_b = _mm_set1_ps(dy_b * (center_y - c.y) - dx_b * c.x);
+		__m128 row_c = _mm_set1_ps(dy_c * (center_y - a.y) - dx_c * a.x);
+		uint32_t* color_row = color.data() + static_cast<size_t>(y) * stride;
+		float* depth_row = depth.data() + static_cast<size_t>(y) * stride;
+
+		for (int x = start_x; x <= x1; x += 4)
+		{
+			__m128 center_x = _mm_add_ps(_mm_set1_ps(static_cast<float>(x)), lane_centers);
+			__m128 edge_a = _mm_add_ps(_mm_mul_ps(step_a, center_x), row_a);
+			__m128 edge_b = _mm_add_ps(_mm_mul_ps(step_b, center_x), row_b);
+			__m128 edge_c = _mm_add_ps(_mm_mul_ps(step_c, center_x), row_c);
+
+			__m128 inside = _mm_and_ps(_mm_and_ps(_mm_cmpge_ps(edge_a, zero), _mm_cmpge_ps(edge_b, zero)), _mm_cmpge_ps(edge_c, zero));
+			inside = _mm_and_ps(inside, _mm_and_ps(_mm_cmpge_ps(center_x, first_center), _mm_cmple_ps(center_x, last_center)));
+			if (_mm_movemask_ps(inside) == 0)
+				continue;
+
+			__m128 weight_b = _mm_mul_ps(edge_b, area_scale);
+			__m128 weight_c = _mm_mul_ps(edge_c, area_scale);
+			__m128 z = _mm_add_ps(z_a, _mm_add_ps(_mm_mul_ps(weight_b, z_b), _mm_mul_ps(weight_c, z_c)));
+			__m128 stored = _mm_loadu_ps(depth_row + x);
+
+			//GL_LESS, and the near and far planes clip per pixel
+			__m128 pass = _mm_and_ps(inside, _mm_and_ps(_mm_cmplt_ps(z, stored), _mm_and_ps(_mm_cmpge_ps(z, zero), _mm_cmple_ps(z, one))));
+			int mask = _mm_movemask_ps(pass);
+			if (mask == 0)
+				continue;
+
+			_mm_storeu_ps(depth_row + x, _mm_or_ps(_mm_and_ps(pass, z), _mm_andnot_ps(pass, stored)));
+
+			float weights_a[4], weights_b[4], weights_c[4];
+			_mm_storeu_ps(weights_a, _mm_mul_ps(edge_a, area_scale));
+			_mm_storeu_ps(weights_b, weight_b);
+			_mm_storeu_ps(weights_c, weight_c);
+			for (int lane = 0; lane < 4; lane++)
+			{
+				if (mask & (1 << lane))
+					color_row[x + lane] = Shade(a, b, c, weights_a[lane], weights_b[lane], weights_c[lane], triangle_color);
+			}
+		}
+	}
+#else
+	for (int y = y0; y <= y1; y++)
+	{
+		float center_y = y + 0.5f;
+		uint32_t* color_row = color.data() + static_cast<size_t>(y) * stride;
+		float* depth_row = depth.data() + static_cast<size_t>(y) * stride;
+
+		for (int x = x0; x <= x1; x++)
+		{
+			float center_x = x + 0.5f;
+			float edge_a = dx_a * center_x + (dy_a * (center_y - b.y) - dx_a * b.x);
+			float edge_b = dx_b * center_x + (dy_b * (center_y - c.y) - dx_b * c.x);
+			float edge_c = dx_c * center_x + (dy_c * (center_y - a.y) - dx_c * a.x);
+			if (edge_a < 0.f || edge_b < 0.f || edge_c < 0.f)
+				continue;
+
+			float weight_b = edge_b * inv_area;
+			float weight_c = edge_c * inv_area;
+			float z = a.z + (weight_b * dz_b + weight_c * dz_c);
+			if (!(z < depth_row[x]) || z < 0.f || z > 1.f)
+				continue;
+
+			depth_row[x] = z;
+			color_row[x] = Shade(a, b, c, edge_a * inv_area, weight_b, weight_c, triangle_color);
+		}
+	}
+#endif
+}
+
+//default.frag with the normal and position interpolated perspective correct
+uint32_t SoftwareRasterizer::Shade(const ScreenVertex& a, const ScreenVertex& b, const ScreenVertex& c, float wa, float wb, float wc, glm::vec3 triangle_color) const
+{
+	const glm::vec3 light_position = glm::vec3(25.f, 50.f, 0.f);
+
+	float pa = wa * a.inv_w, pb = wb * b.inv_w, pc = wc * c.inv_w;
+	float inv_sum = 1.f / (pa + pb + pc);
+	glm::vec3 normal = (pa * a.normal + pb * b.normal + pc * c.normal) * inv_sum;
+	glm::vec3 world = (pa * a.world + pb * b.world + pc * c.world) * inv_sum;
+
+	float diffuse = glm::max(0.65f, glm::dot(glm::normalize(normal), glm::normalize(light_position - world)));
+	return PackColor(triangle_color * diffuse);
+}
+
+bool SoftwareRasterizer::WritePPM(const std::string& path) const
+{
+	std::string header = "P6\n" + std::to_string(width) + " " + std::to_string(height) + "\n255\n";
+	std::vector<char> file(header.begin(), header.end());
+	file.reserve(header.size() + static_cast<size_t>(width) * height * 3);
+
+	for (int y = 0; y < height; y++)
+	{
+		const uint32_t* row = Row(y);
+		for (int x = 0; x < width; x++)
+		{
+			file.push_back(static_cast<char>(row[x] & 0xFF));
+			file.push_back(static_cast<char>(row[x] >> 8 & 0xFF));
+			file.push_back(static_cast<char>(row[x] >> 16 & 0xFF));
+		}
+	}
+
+	return FileManager::WriteBinaryFile(path, file);
+}
+
+int SoftwareRasterizer::Lanes()
+{
+	return RASTER_LANES;
+}
+
+void SoftwareRasterizer::ParallelFor(size_t count, const std::function<void(size_t)>& body)
+{
+	if (workers.empty() || count <= 1)
+	{
+		for (size_t i = 0; i < count; i++)
+		{
+			body(i);
+		}
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		job = &body;
+		job_count = count;
+		next_item = 0;
+		busy = workers.size();
+		generation++;
+	}
+	wake.notify_all();
+
+	RunItems();
+
+	std::unique_lock<std::mutex> lock(mutex);
+	done.wait(lock, [this]
+	{
+		return busy == 0;
+	});
+	job = nullptr;
+}
+
+void SoftwareRasterizer::WorkerLoop()
+{
+	Profiler::SetThreadName("Raster");
+	uint64_t seen = 0;
+
+	for (;;)
+	{
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			wake.wait(lock, [this, seen]
+			{
+				return stopping || generation != seen;
+			});
+			if (stopping)
+				return;
+			seen = generation;
+		}
+
+		RunItems();
+
+		std::lock_guard<std::mutex> lock(mutex);
+		if (--busy == 0)
+			done.notify_one();
+	}
+}
+
+void SoftwareRasterizer::RunItems()
+{
+	for (size_t i = next_item++; i < job_count; i = next_item++)
+	{
+		(*job)(i);
+	}
+}
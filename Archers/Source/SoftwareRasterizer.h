@@ -0,0 +1,166 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include "Geometry.h"
+
+//one object of a draw, placed the way the vertex shader places it: position + rotation * (scale * vertex)
+struct RasterInstance
+{
+	glm::quat rotation;
+	glm::vec3 position;
+	glm::vec3 scale;
+	glm::vec3 color;
+};
+
+struct RasterStats
+{
+	//after dropping the ones that cover no pixel center
+	size_t triangles = 0;
+	//triangle and tile pairs, a triangle is rasterized once per tile its bounds touch
+	size_t binned = 0;
+	double setup_seconds = 0.0;
+	double raster_seconds = 0.0;
+};
+
+//draws meshes into memory with the shading of default.frag, no GL or GPU needed. Instances are transformed and their
+//triangles binned into screen tiles in parallel, then each tile is cleared and rasterized by one thread with edge
+//functions evaluated for 4 pixels at once. The image doesn't depend on the number of threads
+class SoftwareRasterizer
+{
+public:
+	static const int tile_size = 64;
+
+	//threads 0 uses every hardware thread, the calling one included
+	SoftwareRasterizer(int width, int height, int threads = 0);
+	~SoftwareRasterizer();
+
+	SoftwareRasterizer(const SoftwareRasterizer&) = delete;
+	SoftwareRasterizer& operator=(const SoftwareRasterizer&) = delete;
+
+	void Resize(int new_width, int new_height);
+
+	//draws until End use this camera, color and depth are cleared by End
+	void Begin(const glm::mat4& projection, const glm::mat4& view, glm::vec3 clear_color);
+	//triangles of the mesh once per instance, the arrays are read by End and have to live until then
+	void Draw(const Vertex* vertices, size_t vertex_count, const uint32_t* indices, size_t index_count, const RasterInstance* instances,
+		size_t instance_count);
+	void End();
+
+	int Width() const
+	{
+		return width;
+	}
+
+	int Height() const
+	{
+		return height;
+	}
+
+	//RGBA8 as bytes in memory, rows from the top of the image
+	const uint32_t* Row(int y) const
+	{
+		return color.data() + static_cast<size_t>(y) * stride;
+	}
+
+	//window depth in [0, 1] as GL stores it
+	const float* DepthRow(int y) const
+	{
+		return depth.data() + static_cast<size_t>(y) * stride;
+	}
+
+	bool WritePPM(const std::string& path) const;
+
+	const RasterStats& Stats() const
+	{
+		return stats;
+	}
+
+	int Threads() const
+	{
+		return static_cast<int>(workers.size()) + 1;
+	}
+
+	//pixels tested at once, 4 when built with SSE2, 1 otherwise
+	static int Lanes();
+
+private:
+	struct DrawCall
+	{
+		const Vertex* vertices;
+		size_t vertex_count;
+		const uint32_t* indices;
+		size_t index_count;
+		const RasterInstance* instances;
+		size_t instance_count;
+	};
+
+	//vertex after the vertex shader, x and y in pixels and z as window depth
+	struct ScreenVertex
+	{
+		float x, y, z;
+		//1 / clip w, attributes are interpolated divided by w for perspective projections
+		float inv_w;
+		glm::vec3 world;
+		glm::vec3 normal;
+	};
+
+	//counter clockwise on screen, clockwise ones are flipped during setup since nothing is back face culled
+	struct ScreenTriangle
+	{
+		uint32_t v[3];
+		glm::vec3 color;
+	};
+
+	//instances of one draw set up by one thread, kept apart so tiles see triangles in submission order
+	struct Chunk
+	{
+		size_t draw;
+		size_t first_instance;
+		size_t instance_count;
+		std::vector<ScreenVertex> vertices;
+		std::vector<ScreenTriangle> triangles;
+		//triangles touching each tile
+		std::vector<std::vector<uint32_t>> bins;
+	};
+
+	void SetupChunk(Chunk& chunk);
+	void RasterizeTile(int tile);
+	void RasterizeTriangle(const ScreenVertex& a, const ScreenVertex& b, const ScreenVertex& c, glm::vec3 triangle_color, int x0, int y0, int x1, int y1);
+	uint32_t Shade(const ScreenVertex& a, const ScreenVertex& b, const ScreenVertex& c, float wa, float wb, float wc, glm::vec3 triangle_color) const;
+
+	//body runs once for every index below count, spread over the workers and the calling thread
+	void ParallelFor(size_t count, const std::function<void(size_t)>& body);
+	void WorkerLoop();
+	void RunItems();
+
+	int width = 0;
+	int height = 0;
+	//pixels per row, a multiple of 4 so that every group of 4 stays inside its row
+	int stride = 0;
+	int tiles_x = 0;
+	int tiles_y = 0;
+	std::vector<uint32_t> color;
+	std::vector<float> depth;
+	uint32_t clear_rgba = 0;
+	glm::mat4 view_projection = glm::mat4(1.f);
+
+	std::vector<DrawCall> draws;
+	std::vector<Chunk> chunks;
+	size_t used_chunks = 0;
+	RasterStats stats;
+
+	std::vector<std::thread> workers;
+	std::mutex mutex;
+	std::condition_variable wake;
+	std::condition_variable done;
+	const std::function<void(size_t)>* job = nullptr;
+	size_t job_count = 0;
+	std::atomic<size_t> next_item{ 0 };
+	size_t busy = 0;
+	uint64_t generation = 0;
+	bool stopping = false;
+};
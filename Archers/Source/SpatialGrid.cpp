@@ -0,0 +1,157 @@
+#include "SpatialGrid.h"
+#include <cfloat>
+#include <algorithm>
+
+SpatialGrid::SpatialGrid(float cell_size)
+{
+	this->cell_size = cell_size;
+	inv_cell_size = 1.f / cell_size;
+}
+
+void SpatialGrid::Clear()
+{
+	entries.clear();
+	tree.clear();
+	bucket_start.clear();
+	bucket_mask = 0;
+	min_cx = min_cz = 0;
+	max_cx = max_cz = -1;
+}
+
+void SpatialGrid::Insert(entt::entity entity, glm::vec3 pos)
+{
+	entries.push_back({ entity, pos, CellCoord(pos.x), CellCoord(pos.z) });
+}
+
+void SpatialGrid::Build()
+{
+	if (entries.empty())
+		return;
+
+	size_t buckets = 1;
+	while (buckets < entries.size())
+		buckets <<= 1;
+	bucket_mask = buckets - 1;
+
+	min_cx = max_cx = entries[0].cx;
+	min_cz = max_cz = entries[0].cz;
+	bucket_start.assign(buckets + 1, 0);
+
+	for (const GridEntry& entry : entries)
+	{
+		min_cx = glm::min(min_cx, entry.cx);
+		max_cx = glm::max(max_cx, entry.cx);
+		min_cz = glm::min(min_cz, entry.cz);
+		max_cz = glm::max(max_cz, entry.cz);
+		bucket_start[Bucket(entry.cx, entry.cz) + 1]++;
+	}
+
+	for (size_t i = 1; i <= buckets; i++)
+	{
+		bucket_start[i] += bucket_start[i - 1];
+	}
+
+	//counting sort, bucket_start is shifted back by one slot while filling
+	scratch.resize(entries.size());
+	for (const GridEntry& entry : entries)
+	{
+		scratch[bucket_start[Bucket(entry.cx, entry.cz)]++] = entry;
+	}
+
+	for (size_t i = buckets; i > 0; i--)
+	{
+		bucket_start[i] = bucket_start[i - 1];
+	}
+	bucket_start[0] = 0;
+
+	entries.swap(scratch);
+
+	tree.assign(entries.begin(), entries.end());
+	tree_min = tree_max = tree[0].pos;
+	for (const GridEntry& entry : tree)
+	{
+		tree_min = glm::min(tree_min, entry.pos);
+		tree_max = glm::max(tree_max, entry.pos);
+	}
+	BuildTree(0, tree.size(), 0);
+}
+
+bool SpatialGrid::FindNearest(glm::vec3 pos, GridEntry& out, float& out_distance) const
+{
+	if (tree.empty())
+		return false;
+
+	float best_sq = FLT_MAX;
+	const GridEntry* best = nullptr;
+	SearchTree(0, tree.size(), 0, tree_min, tree_max, pos, best_sq, best);
+
+	out = *best;
+	out_distance = glm::sqrt(best_sq);
+	return true;
+}
+
+void SpatialGrid::BuildTree(size_t lo, size_t hi, int axis)
+{
+	if (hi - lo <= tree_leaf_size)
+		return;
+
+	size_t mid = (lo + hi) / 2;
+	std::nth_element(tree.begin() + lo, tree.begin() + mid, tree.begin() + hi, [axis](const GridEntry& a, const GridEntry& b)
+	{
+		return a.pos[axis] < b.pos[axis];
+	});
+
+	//splits alternate between X and Z
+	BuildTree(lo, mid, axis ^ 2);
+	BuildTree(mid + 1, hi, axis ^ 2);
+}
+
+void SpatialGrid::SearchTree(size_t lo, size_t hi, int axis, glm::vec3 region_min, glm::vec3 region_max, glm::vec3 pos, float& best_sq, const GridEntry*& best) const
+{
+	//the whole subtree lies within its region, skip it if the region is farther than the best so far
+	glm::vec3 outside = glm::max(glm::max(region_min - pos, pos - region_max), glm::vec3(0.f));
+	outside.y = 0.f;
+	if (glm::dot(outside, outside) >= best_sq)
+		return;
+
+	auto test = [&](const GridEntry& entry)
+	{
+		glm::vec3 diff = entry.pos - pos;
+		float dist_sq = glm::dot(diff, diff);
+		if (dist_sq < best_sq)
+		{
+			best_sq = dist_sq;
+			best = &entry;
+		}
+	};
+
+	if (hi - lo <= tree_leaf_size)
+	{
+		for (size_t i = lo; i < hi; i++)
+		{
+			test(tree[i]);
+		}
+		return;
+	}
+
+	size_t mid = (lo + hi) / 2;
+	test(tree[mid]);
+
+	float split = tree[mid].pos[axis];
+	glm::vec3 left_max = region_max;
+	glm::vec3 right_min = region_min;
+	left_max[axis] = split;
+	right_min[axis] = split;
+
+	//the side holding pos first, it most likely tightens the bound for the other one
+	if (pos[axis] < split)
+	{
+		SearchTree(lo, mid, axis ^ 2, region_min, left_max, pos, best_sq, best);
+		SearchTree(mid + 1, hi, axis ^ 2, right_min, region_max, pos, best_sq, best);
+	}
+	else
+	{
+		SearchTree(mid + 1, hi, axis ^ 2, right_min, region_max, pos, best_sq, best);
+		SearchTree(lo, mid, axis ^ 2, region_min, left_max, pos, best_sq, best);
+	}
+}
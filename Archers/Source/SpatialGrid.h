@@ -0,0 +1,191 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include <glm.hpp>
+#include <entt.hpp>
+
+struct GridEntry
+{
+	entt::entity entity;
+	glm::vec3 pos;
+	int32_t cx;
+	int32_t cz;
+};
+
+//uniform grid over the XZ plane, cells are hashed into a table sized by the number of entries
+//nearest lookups go through a k-d tree built alongside, ring search over cells degrades to scanning
+//the whole occupied area when the closest entry is far away (armies approaching from opposite corners)
+class SpatialGrid
+{
+public:
+	SpatialGrid(float cell_size = 4.f);
+
+	void Clear();
+	void Insert(entt::entity entity, glm::vec3 pos);
+	//sort inserted entries into their cells, has to be called once after all insertions
+	void Build();
+
+	//closest entry to pos (3D distance), returns false if the grid is empty
+	bool FindNearest(glm::vec3 pos, GridEntry& out, float& out_distance) const;
+
+	//calls visit(const GridEntry&) for every entry within radius of center
+	template<typename Func>
+	void QueryRadius(glm::vec3 center, float radius, Func&& visit) const
+	{
+		float radius_sq = radius * radius;
+
+		VisitCells(center.x - radius, center.z - radius, center.x + radius, center.z + radius, [&](const GridEntry& entry)
+		{
+			glm::vec3 diff = entry.pos - center;
+			if (glm::dot(diff, diff) <= radius_sq)
+			{
+				visit(entry);
+			}
+		});
+	}
+
+	//calls visit(const GridEntry&, float t) for every entry whose sphere of given radius is crossed by the segment a->b,
+	//t is the fraction of the segment at which it enters the sphere
+	template<typename Func>
+	void QuerySegment(glm::vec3 a, glm::vec3 b, float radius, Func&& visit) const
+	{
+		glm::vec3 lo = glm::min(a, b) - radius;
+		glm::vec3 hi = glm::max(a, b) + radius;
+
+		VisitCells(lo.x, lo.z, hi.x, hi.z, [&](const GridEntry& entry)
+		{
+			float t;
+			if (SegmentHitsSphere(a, b, entry.pos, radius, t))
+			{
+				visit(entry, t);
+			}
+		});
+	}
+
+	//earliest fraction of a->b that lies inside the sphere, false if the segment misses it
+	static bool SegmentHitsSphere(glm::vec3 a, glm::vec3 b, glm::vec3 center, float radius, float& out_t)
+	{
+		glm::vec3 dir = b - a;
+		glm::vec3 rel = a - center;
+		float c = glm::dot(rel, rel) - radius * radius;
+
+		if (c < 0.f)
+		{
+			out_t = 0.f;
+			return true;
+		}
+
+		float len_sq = glm::dot(dir, dir);
+		float proj = glm::dot(rel, dir);
+		//standing still or moving away from the center
+		if (len_sq <= 0.f || proj >= 0.f)
+			return false;
+
+		float disc = proj * proj - len_sq * c;
+		if (disc < 0.f)
+			return false;
+
+		float t = (-proj - glm::sqrt(disc)) / len_sq;
+		if (t > 1.f)
+			return false;
+
+		out_t = t;
+		return true;
+	}
+
+	size_t Size() const
+	{
+		return entries.size();
+	}
+
+private:
+	void BuildTree(size_t lo, size_t hi, int axis);
+	void SearchTree(size_t lo, size_t hi, int axis, glm::vec3 region_min, glm::vec3 region_max, glm::vec3 pos, float& best_sq, const GridEntry*& best) const;
+
+	//calls visit(const GridEntry&) for every entry binned in cells overlapping the XZ rectangle
+	template<typename Func>
+	void VisitCells(float min_x, float min_z, float max_x, float max_z, Func&& visit) const
+	{
+		if (entries.empty())
+			return;
+
+		int32_t x0 = glm::max(CellCoord(min_x), min_cx);
+		int32_t x1 = glm::min(CellCoord(max_x), max_cx);
+		int32_t z0 = glm::max(CellCoord(min_z), min_cz);
+		int32_t z1 = glm::min(CellCoord(max_z), max_cz);
+
+		for (int32_t x = x0; x <= x1; x++)
+		{
+			for (int32_t z = z0; z <= z1; z++)
+			{
+				size_t bucket = Bucket(x, z);
+				for (uint32_t i = bucket_start[bucket]; i < bucket_start[bucket + 1]; i++)
+				{
+					//different cells can share a bucket, skip entries from those
+					if (entries[i].cx == x && entries[i].cz == z)
+					{
+						visit(entries[i]);
+					}
+				}
+			}
+		}
+	}
+
+	int32_t CellCoord(float value) const
+	{
+		return static_cast<int32_t>(glm::floor(value * inv_cell_size));
+	}
+
+	size_t Bucket(int32_t cx, int32_t cz) const
+	{
+		return ((static_cast<uint32_t>(cx) * 73856093u) ^ (static_cast<uint32_t>(cz) * 19349663u)) & bucket_mask;
+	}
+
+	float cell_size;
+	float inv_cell_size;
+	size_t bucket_mask = 0;
+	int32_t min_cx = 0, max_cx = -1;
+	int32_t min_cz = 0, max_cz = -1;
+	//grouped by bucket after Build
+	std::vector<GridEntry> entries;
+	std::vector<GridEntry> scratch;
+	std::vector<uint32_t> bucket_start;
+	//implicit k-d tree, median of every range splits it on X or Z
+	std::vector<GridEntry> tree;
+	glm::vec3 tree_min;
+	glm::vec3 tree_max;
+	static const size_t tree_leaf_size = 8;
+};
+
+struct ArcherTarget
+{
+	entt::entity entity = entt::null;
+	//-1 when the target is an ally we are colliding with
+	float distance = 0.f;
+};
+
+//friendly collision takes priority over the nearest foe
+inline ArcherTarget AcquireTarget(const SpatialGrid& allies, const SpatialGrid& foes, entt::entity self, glm::vec3 pos, float collision_distance)
+{
+	ArcherTarget target;
+
+	allies.QueryRadius(pos, collision_distance, [&](const GridEntry& other)
+	{
+		if (other.entity != self)
+		{
+			target.entity = other.entity;
+			target.distance = -1.f;
+		}
+	});
+
+	if (target.entity == entt::null)
+	{
+		GridEntry foe;
+		if (foes.FindNearest(pos, foe, target.distance))
+		{
+			target.entity = foe.entity;
+		}
+	}
+
+	return target;
+}
@@ -0,0 +1,61 @@
+#include "StaticBatch.h"
+
+StaticBatcher::~StaticBatcher()
+{
+	Clear();
+}
+
+void StaticBatcher::Build(entt::registry& registry, VertexFormat format)
+{
+	Clear();
+
+	for (auto object : registry.view<StaticMesh, MeshComponent>())
+	{
+		MeshComponent& object_mesh = registry.get<MeshComponent>(object);
+		Mesh* mesh = object_mesh.get();
+		glm::vec3 color = object_mesh.color();
+
+		Batch* batch = nullptr;
+		for (Batch& existing : batches)
+		{
+			if (existing.color == color)
+				batch = &existing;
+		}
+		if (batch == nullptr)
+		{
+			batches.push_back(Batch());
+			batches.back().color = color;
+			batch = &batches.back();
+		}
+
+		Geometry::AppendTransformed(mesh->Vertices(), mesh->NumVerts(), mesh->Indices(), mesh->NumIndices(), registry.get<Position>(object).coord,
+			registry.get<Orientation>(object).ori, object_mesh.scale(), batch->vertices, batch->indices);
+		merged_entities++;
+	}
+
+	for (Batch& batch : batches)
+	{
+		batch.mesh = new Mesh(batch.vertices, batch.indices, format);
+		//the arena's copy is all that's needed from now on
+		batch.vertices = std::vector<Vertex>();
+		batch.indices = std::vector<uint32_t>();
+	}
+}
+
+void StaticBatcher::Submit(InstancedRenderer& renderer)
+{
+	for (Batch& batch : batches)
+	{
+		renderer.Add(batch.mesh, glm::vec3(0.f), glm::quat(1.f, 0.f, 0.f, 0.f), glm::vec3(1.f), batch.color);
+	}
+}
+
+void StaticBatcher::Clear()
+{
+	for (Batch& batch : batches)
+	{
+		delete batch.mesh;
+	}
+	batches.clear();
+	merged_entities = 0;
+}
@@ -0,0 +1,54 @@
+#pragma once
+#include "Renderer.h"
+#include "EntityComponents.h"
+
+//geometry of entities that never move, merged once into pre-transformed meshes so drawing it costs
+//one instance per color no matter how many entities it was built from
+class StaticBatcher
+{
+public:
+	StaticBatcher() = default;
+	~StaticBatcher();
+
+	StaticBatcher(const StaticBatcher&) = delete;
+	StaticBatcher& operator=(const StaticBatcher&) = delete;
+
+	//merges every entity tagged with StaticMesh into meshes of the given vertex format, replaces batches of an earlier Build
+	void Build(entt::registry& registry, VertexFormat format = VertexFormat::Float);
+	void Submit(InstancedRenderer& renderer);
+
+	size_t Batches() const
+	{
+		return batches.size();
+	}
+
+	size_t MergedEntities() const
+	{
+		return merged_entities;
+	}
+
+	size_t VertexBytes() const
+	{
+		size_t bytes = 0;
+		for (const Batch& batch : batches)
+		{
+			bytes += batch.mesh->VertexBytes();
+		}
+		return bytes;
+	}
+
+private:
+	//the color is a per-instance attribute, so entities of different colors can't share a mesh
+	struct Batch
+	{
+		glm::vec3 color;
+		std::vector<Vertex> vertices;
+		std::vector<uint32_t> indices;
+		Mesh* mesh = nullptr;
+	};
+
+	void Clear();
+
+	std::vector<Batch> batches;
+	size_t merged_entities = 0;
+};
@@ -0,0 +1,115 @@
+#include "StreamBuffer.h"
+#include <chrono>
+#include "Profiler.h"
+
+StreamBuffer::StreamBuffer(RenderBackend& stream_backend, size_t region_bytes, int regions) : backend(stream_backend)
+{
+	region_count = regions;
+	fences.assign(regions, nullptr);
+	Create(region_bytes);
+	//the first BeginFrame moves to region 0
+	region = regions - 1;
+}
+
+StreamBuffer::~StreamBuffer()
+{
+	for (RenderFence fence : fences)
+	{
+		if (fence != nullptr)
+			backend.DeleteFence(fence);
+	}
+	retired.push_back(buffer);
+	//deleting a buffer unmaps it
+	for (uint32_t old_buffer : retired)
+	{
+		backend.DeleteBuffer(old_buffer);
+	}
+}
+
+void StreamBuffer::BeginFrame()
+{
+	region = (region + 1) % region_count;
+	WaitRegion(region);
+	region_offset = 0;
+	stats.frame_bytes = 0;
+}
+
+StreamAllocation StreamBuffer::Allocate(size_t bytes, size_t alignment)
+{
+	size_t start = (region_offset + alignment - 1) / alignment * alignment;
+
+	if (start + bytes > region_size)
+	{
+		//slices handed out earlier this frame stay valid, the old buffer is deleted once the frame is submitted
+		retired.push_back(buffer);
+		Create(glm::max(region_size * 2, bytes + alignment));
+		//the new buffer isn't used by any frame in flight
+		for (RenderFence& fence : fences)
+		{
+			if (fence != nullptr)
+				backend.DeleteFence(fence);
+			fence = nullptr;
+		}
+		start = 0;
+		stats.grows++;
+	}
+
+	StreamAllocation allocation;
+	allocation.buffer = buffer;
+	allocation.offset = region * region_size + start;
+	allocation.data = mapped + allocation.offset;
+
+	region_offset = start + bytes;
+	stats.frame_bytes += bytes;
+	stats.total_bytes += bytes;
+
+	return allocation;
+}
+
+void StreamBuffer::EndFrame()
+{
+	fences[region] = backend.InsertFence();
+
+	//the draws of this frame keep the storage alive until they are done
+	for (uint32_t old_buffer : retired)
+	{
+		backend.DeleteBuffer(old_buffer);
+	}
+	retired.clear();
+
+	stats.frames++;
+}
+
+void StreamBuffer::Create(size_t new_region_bytes)
+{
+	region_size = new_region_bytes;
+
+	void* storage = nullptr;
+	buffer = backend.CreateMappedBuffer(region_size * region_count, &storage);
+	mapped = static_cast<uint8_t*>(storage);
+}
+
+void StreamBuffer::WaitRegion(int index)
+{
+	if (fences[index] == nullptr)
+		return;
+
+	bool signaled = backend.WaitFence(fences[index], 0);
+	if (signaled == false)
+	{
+		PROFILE_ZONE("FenceStall");
+		auto start = std::chrono::steady_clock::now();
+
+		//the GPU is more than region_count frames behind
+		while (signaled == false)
+		{
+			signaled = backend.WaitFence(fences[index], 1000000);
+		}
+
+		stats.fence_stalls++;
+		stats.stall_seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	}
+
+	backend.DeleteFence(fences[index]);
+	fences[index] = nullptr;
+}
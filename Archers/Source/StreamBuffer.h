@@ -0,0 +1,71 @@
+#pragma once
+#include <vector>
+#include "RenderBackend.h"
+
+//a slice of the stream buffer written by the CPU this frame
+struct StreamAllocation
+{
+	void* data = nullptr;
+	//buffer holding the slice, it changes when the stream buffer grows
+	uint32_t buffer = 0;
+	//from the start of the buffer, for vertex buffer bindings and uniform or storage ranges
+	size_t offset = 0;
+};
+
+struct StreamStats
+{
+	size_t frame_bytes = 0;
+	uint64_t total_bytes = 0;
+	uint64_t frames = 0;
+	//frames that had to wait for the GPU to finish reading their region
+	uint64_t fence_stalls = 0;
+	double stall_seconds = 0.0;
+	//times the regions were reallocated to fit a frame
+	uint64_t grows = 0;
+};
+
+//persistently mapped buffer split into one region per frame in flight, the CPU writes a frame's instance and
+//camera data straight into GPU visible memory and a fence per region keeps it from overwriting data still in use
+class StreamBuffer
+{
+public:
+	StreamBuffer(RenderBackend& stream_backend, size_t region_bytes = 1 << 20, int regions = 3);
+	~StreamBuffer();
+
+	StreamBuffer(const StreamBuffer&) = delete;
+	StreamBuffer& operator=(const StreamBuffer&) = delete;
+
+	//moves to the next region, waiting for its fence if the GPU is still reading it
+	void BeginFrame();
+	//bytes of this frame's region, grows the buffer when the region is full
+	StreamAllocation Allocate(size_t bytes, size_t alignment = 16);
+	//fences the region, call after the last draw reading from it
+	void EndFrame();
+
+	uint32_t Buffer() const
+	{
+		return buffer;
+	}
+
+	const StreamStats& Stats() const
+	{
+		return stats;
+	}
+
+private:
+	void Create(size_t new_region_bytes);
+	void WaitRegion(int index);
+
+	RenderBackend& backend;
+	uint32_t buffer = 0;
+	uint8_t* mapped = nullptr;
+	size_t region_size = 0;
+	int region_count = 0;
+	int region = 0;
+	size_t region_offset = 0;
+	std::vector<RenderFence> fences;
+	//replaced by a bigger buffer during this frame, still mapped for allocations made before the grow
+	std::vector<uint32_t> retired;
+
+	StreamStats stats;
+};
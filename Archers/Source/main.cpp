@@ -1,13 +1,54 @@
+#include <cstdlib>
+#include <cstring>
 #include "Game.h"
 
 ArchersGame* game_instance = nullptr;
 
 int main(int argc, char* argv[])
 {
-    game_instance = new ArchersGame();
+    //--archers N plays a battle of N archers at the density of the default one
+    SimulationSettings settings;
+    for (int i = 1; i + 1 < argc; i++)
+    {
+        if (strcmp(argv[i], "--archers") == 0)
+            settings = SimulationSettings::Scaled(atoi(argv[i + 1]));
+    }
+
+    game_instance = new ArchersGame(settings);
     if (!game_instance->Prepare())
         return -1;
 
+    //--trace FILE captures from the first frame, F9 starts and stops a capture at any time
+    //--capture TARGET records the window from the first frame, F11 starts and stops a recording at any time
+    //--single-thread simulates on the render thread between frames instead of alongside them
+    //--meshes draws archers as sphere meshes instead of impostors, I switches at any time
+    //--gpu-culling culls and submits the draws on the GPU, G switches at any time
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--trace") == 0 && i + 1 < argc)
+        {
+            game_instance->SetTracePath(argv[i + 1]);
+            game_instance->ToggleTrace();
+        }
+        else if (strcmp(argv[i], "--capture") == 0 && i + 1 < argc)
+        {
+            game_instance->SetCaptureTarget(argv[i + 1]);
+            game_instance->ToggleCapture();
+        }
+        else if (strcmp(argv[i], "--single-thread") == 0)
+        {
+            game_instance->SetThreadedSimulation(false);
+        }
+        else if (strcmp(argv[i], "--meshes") == 0)
+        {
+            game_instance->SetImpostors(false);
+        }
+        else if (strcmp(argv[i], "--gpu-culling") == 0)
+        {
+            game_instance->SetGpuCulling(true);
+        }
+    }
+
     game_instance->SetupEvents();
     game_instance->GameCycle();
     delete game_instance;
@@ -0,0 +1,226 @@
+#include "Bench.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <thread>
+
+const std::vector<size_t> battle_counts = { 40, 400, 4000, 40000, 400000, 1000000 };
+
+static volatile double bench_sink = 0.0;
+
+void BenchConsume(double value)
+{
+	bench_sink = bench_sink + value;
+}
+
+static double Seconds(std::chrono::steady_clock::time_point start)
+{
+	return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+static void PrintUsage(const char* program)
+{
+	fprintf(stderr, "usage: %s [--filter TEXT] [--max-count N] [--min-time SECONDS] [--out FILE] [--list]\n", program);
+	fprintf(stderr, "the table goes to stderr, the JSON report to FILE or stdout\n");
+}
+
+void BenchSuite::Add(const std::string& name, const std::vector<size_t>& counts, BenchFactory factory)
+{
+	benches.push_back({ name, counts, factory });
+}
+
+int BenchSuite::Run(int argc, char* argv[])
+{
+	std::string filter;
+	std::string out_path;
+	size_t max_count = SIZE_MAX;
+	bool list = false;
+
+	for (int i = 1; i < argc; i++)
+	{
+		if (i + 1 < argc && strcmp(argv[i], "--filter") == 0)
+			filter = argv[++i];
+		else if (i + 1 < argc && strcmp(argv[i], "--max-count") == 0)
+			max_count = strtoull(argv[++i], nullptr, 10);
+		else if (i + 1 < argc && strcmp(argv[i], "--min-time") == 0)
+			min_time = atof(argv[++i]);
+		else if (i + 1 < argc && strcmp(argv[i], "--out") == 0)
+			out_path = argv[++i];
+		else if (strcmp(argv[i], "--list") == 0)
+			list = true;
+		else
+		{
+			PrintUsage(argv[0]);
+			return -1;
+		}
+	}
+
+	fprintf(stderr, "%-24s %9s %8s %13s %13s %13s %14s\n", "bench", "count", "samples", "mean us", "median us", "p99 us", "items/sec");
+
+	for (Bench& bench : benches)
+	{
+		if (filter.empty() == false && bench.name.find(filter) == std::string::npos)
+			continue;
+
+		for (size_t count : bench.counts)
+		{
+			if (count > max_count)
+				continue;
+
+			if (list)
+			{
+				fprintf(stderr, "%s/%zu\n", bench.name.c_str(), count);
+				continue;
+			}
+
+			BenchCase bench_case = bench.factory(count);
+			BenchResult result = Measure(bench.name, count, bench_case);
+			results.push_back(result);
+
+			fprintf(stderr, "%-24s %9zu %8zu %13.3f %13.3f %13.3f %14.4g\n", result.name.c_str(), result.count, result.samples,
+				result.mean_ns * 1e-3, result.median_ns * 1e-3, result.p99_ns * 1e-3, result.items_per_second);
+		}
+	}
+
+	if (list)
+		return 0;
+
+	return WriteJson(out_path) ? 0 : -1;
+}
+
+BenchResult BenchSuite::Measure(const std::string& name, size_t count, BenchCase& bench_case)
+{
+	//first run warms caches and lets lazily allocated storage settle
+	if (bench_case.reset)
+		bench_case.reset();
+	auto warmup_start = std::chrono::steady_clock::now();
+	bench_case.run();
+	double warmup = Seconds(warmup_start);
+
+	//a sample of at least a millisecond keeps the clock overhead out of short runs
+	size_t runs_per_sample = 1;
+	if (!bench_case.reset && warmup < 1e-3)
+	{
+		runs_per_sample = static_cast<size_t>(std::ceil(1e-3 / std::max(warmup, 1e-9)));
+		runs_per_sample = std::min<size_t>(runs_per_sample, 1 << 20);
+	}
+
+	std::vector<double> run_ns;
+	double timed = 0.0;
+	auto wall_start = std::chrono::steady_clock::now();
+
+	while (true)
+	{
+		if (bench_case.reset)
+			bench_case.reset();
+
+		auto start = std::chrono::steady_clock::now();
+		for (size_t i = 0; i < runs_per_sample; i++)
+		{
+			bench_case.run();
+		}
+		double seconds = Seconds(start);
+
+		timed += seconds;
+		run_ns.push_back(seconds * 1e9 / runs_per_sample);
+
+		if (run_ns.size() >= min_samples && timed >= min_time)
+			break;
+		if (run_ns.size() >= max_samples || Seconds(wall_start) >= max_time)
+			break;
+	}
+
+	std::sort(run_ns.begin(), run_ns.end());
+	size_t samples = run_ns.size();
+
+	BenchResult result;
+	result.name = name;
+	result.count = count;
+	result.items = bench_case.items;
+	result.samples = samples;
+	result.runs_per_sample = runs_per_sample;
+	result.mean_ns = 0.0;
+	for (double ns : run_ns)
+	{
+		result.mean_ns += ns;
+	}
+	result.mean_ns /= samples;
+	result.median_ns = samples % 2 == 1 ? run_ns[samples / 2] : 0.5 * (run_ns[samples / 2 - 1] + run_ns[samples / 2]);
+	result.p99_ns = run_ns[static_cast<size_t>(std::ceil(0.99 * samples)) - 1];
+	result.min_ns = run_ns[0];
+	result.items_per_second = result.mean_ns > 0.0 ? bench_case.items * 1e9 / result.mean_ns : 0.0;
+
+	return result;
+}
+
+bool BenchSuite::WriteJson(const std::string& path)
+{
+	FILE* out = path.empty() ? stdout : fopen(path.c_str(), "w");
+	if (out == nullptr)
+	{
+		fprintf(stderr, "can't open %s for writing\n", path.c_str());
+		return false;
+	}
+
+	char date[32];
+	time_t now = time(nullptr);
+	strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S", localtime(&now));
+
+#if defined(__clang__)
+	const char* compiler = "clang " __clang_version__;
+#elif defined(__GNUC__)
+	const char* compiler = "gcc " __VERSION__;
+#elif defined(_MSC_VER)
+	const char* compiler = "msvc";
+#else
+	const char* compiler = "unknown";
+#endif
+
+#ifdef NDEBUG
+	const char* build = "release";
+#else
+	const char* build = "debug";
+#endif
+
+	fprintf(out, "{\n");
+	fprintf(out, "  \"context\": {\n");
+	fprintf(out, "    \"date\": \"%s\",\n", date);
+	fprintf(out, "    \"compiler\": \"%s\",\n", compiler);
+	fprintf(out, "    \"build\": \"%s\",\n", build);
+	fprintf(out, "    \"hardware_threads\": %u,\n", std::thread::hardware_concurrency());
+	fprintf(out, "    \"min_time\": %g\n", min_time);
+	fprintf(out, "  },\n");
+	fprintf(out, "  \"benchmarks\": [");
+
+	for (size_t i = 0; i < results.size(); i++)
+	{
+		const BenchResult& result = results[i];
+		fprintf(out, "%s\n    {\"name\": \"%s/%zu\", \"bench\": \"%s\", \"count\": %zu, \"items\": %zu, \"samples\": %zu, \"runs_per_sample\": %zu, "
+			"\"mean_ns\": %.1f, \"median_ns\": %.1f, \"p99_ns\": %.1f, \"min_ns\": %.1f, \"items_per_second\": %.6g}",
+			i == 0 ? "" : ",", result.name.c_str(), result.count, result.name.c_str(), result.count, result.items, result.samples, result.runs_per_sample,
+			result.mean_ns, result.median_ns, result.p99_ns, result.min_ns, result.items_per_second);
+	}
+
+	fprintf(out, "\n  ]\n}\n");
+
+	if (out != stdout)
+		fclose(out);
+
+	return true;
+}
+
+int main(int argc, char* argv[])
+{
+	BenchSuite suite;
+	RegisterSimulationBenches(suite);
+	RegisterGeometryBenches(suite);
+	RegisterGridBenches(suite);
+	RegisterRasterBenches(suite);
+	RegisterRenderBenches(suite);
+
+	return suite.Run(argc, argv);
+}
@@ -0,0 +1,75 @@
+#pragma once
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <vector>
+
+//one benchmark at one problem size
+struct BenchCase
+{
+	//the timed work
+	std::function<void()> run;
+	//optional, brings the state back before every run and stays out of the timing,
+	//cases without it are run several times per sample to get above the clock resolution
+	std::function<void()> reset;
+	//archers, arrows, vertices... processed by one run
+	size_t items = 0;
+};
+
+//builds the case for a problem size, the setup isn't timed
+typedef std::function<BenchCase(size_t count)> BenchFactory;
+
+struct BenchResult
+{
+	std::string name;
+	size_t count;
+	size_t items;
+	size_t samples;
+	size_t runs_per_sample;
+	//per run
+	double mean_ns;
+	double median_ns;
+	double p99_ns;
+	double min_ns;
+	double items_per_second;
+};
+
+//the counts simulation benches run at, from the default battle up to a million archers
+extern const std::vector<size_t> battle_counts;
+
+class BenchSuite
+{
+public:
+	void Add(const std::string& name, const std::vector<size_t>& counts, BenchFactory factory);
+	//runs the benches matching the command line, prints a table and writes the JSON report
+	int Run(int argc, char* argv[]);
+
+private:
+	struct Bench
+	{
+		std::string name;
+		std::vector<size_t> counts;
+		BenchFactory factory;
+	};
+
+	BenchResult Measure(const std::string& name, size_t count, BenchCase& bench_case);
+	bool WriteJson(const std::string& path);
+
+	std::vector<Bench> benches;
+	std::vector<BenchResult> results;
+	double min_time = 0.25;
+	size_t min_samples = 5;
+	//short cases with a reset would otherwise spend the whole min_time resetting
+	size_t max_samples = 10000;
+	//a single sample over this is all a case gets
+	double max_time = 10.0;
+};
+
+//keeps the optimizer from dropping work whose result is otherwise unused
+void BenchConsume(double value);
+
+void RegisterSimulationBenches(BenchSuite& suite);
+void RegisterGeometryBenches(BenchSuite& suite);
+void RegisterGridBenches(BenchSuite& suite);
+void RegisterRasterBenches(BenchSuite& suite);
+void RegisterRenderBenches(BenchSuite& suite);
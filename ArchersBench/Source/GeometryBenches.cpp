@@ -0,0 +1,123 @@
+#include <cstdio>
+#include <memory>
+#include <random>
+#include "Bench.h"
+#include "../../Archers/Source/Geometry.h"
+#include "../../Archers/Source/Culling.h"
+#include <gtc/matrix_transform.hpp>
+
+//sphere meshes are built at load time, counts are rings and slices of the sphere
+static const std::vector<size_t> sphere_segments = { 8, 32, 128, 512 };
+
+void RegisterGeometryBenches(BenchSuite& suite)
+{
+	suite.Add("GenerateSphere", sphere_segments, [](size_t count)
+	{
+		int segments = static_cast<int>(count);
+		std::shared_ptr<std::vector<Vertex>> vertices = std::make_shared<std::vector<Vertex>>();
+		std::shared_ptr<std::vector<uint32_t>> indices = std::make_shared<std::vector<uint32_t>>();
+
+		BenchCase bench_case;
+		bench_case.items = (count + 1) * (count + 1);
+		bench_case.run = [segments, vertices, indices]()
+		{
+			Geometry::GenerateSphere(1.f, segments, segments, *vertices, *indices);
+			BenchConsume(vertices->back().pos.x);
+		};
+		return bench_case;
+	});
+
+	suite.Add("CalculateNormals", sphere_segments, [](size_t count)
+	{
+		int segments = static_cast<int>(count);
+		std::shared_ptr<std::vector<Vertex>> vertices = std::make_shared<std::vector<Vertex>>();
+		std::shared_ptr<std::vector<uint32_t>> indices = std::make_shared<std::vector<uint32_t>>();
+		Geometry::GenerateSphere(1.f, segments, segments, *vertices, *indices);
+
+		BenchCase bench_case;
+		bench_case.items = vertices->size();
+		bench_case.run = [vertices, indices]()
+		{
+			Geometry::CalculateNormals(*vertices, *indices);
+			BenchConsume(vertices->back().normal.x);
+		};
+		return bench_case;
+	});
+
+	suite.Add("PackVertices", sphere_segments, [](size_t count)
+	{
+		int segments = static_cast<int>(count);
+		std::shared_ptr<std::vector<Vertex>> vertices = std::make_shared<std::vector<Vertex>>();
+		std::shared_ptr<std::vector<PackedVertex>> packed = std::make_shared<std::vector<PackedVertex>>();
+		std::vector<uint32_t> indices;
+		Geometry::GenerateSphere(1.7f, segments, segments, *vertices, indices);
+		Geometry::CalculateNormals(*vertices, indices);
+
+		//normals have to survive the octahedral round trip within a fraction of a degree
+		glm::vec3 offset, scale;
+		Geometry::PackVertices(*vertices, *packed, offset, scale);
+		float worst = 1.f;
+		for (size_t i = 0; i < vertices->size(); i++)
+		{
+			glm::vec2 encoded = glm::max(glm::vec2((*packed)[i].normal[0], (*packed)[i].normal[1]) / 32767.f, -1.f);
+			worst = glm::min(worst, glm::dot(Geometry::OctahedralDecode(encoded), (*vertices)[i].normal));
+		}
+		if (worst < 0.99999f)
+			fprintf(stderr, "PackVertices/%zu: normal off by %f degrees\n", count, glm::degrees(glm::acos(worst)));
+
+		BenchCase bench_case;
+		bench_case.items = vertices->size();
+		bench_case.run = [vertices, packed]()
+		{
+			glm::vec3 offset, scale;
+			Geometry::PackVertices(*vertices, *packed, offset, scale);
+			BenchConsume(static_cast<double>(packed->back().pos[0]));
+		};
+		return bench_case;
+	});
+
+	//archer sized spheres over a field twice as wide as the game's camera, about a quarter of them visible
+	auto make_culling_case = [](size_t count, bool simd)
+	{
+		std::mt19937 rng(1234);
+		float half_extent = 2.f * glm::sqrt(static_cast<float>(count));
+		std::uniform_real_distribution<float> coord(-half_extent, half_extent);
+		std::shared_ptr<SphereSet> spheres = std::make_shared<SphereSet>();
+		for (size_t i = 0; i < count; i++)
+		{
+			spheres->Add(glm::vec3(coord(rng), 2.5f, coord(rng)), 1.7f);
+		}
+
+		float half_view = half_extent / 2.f;
+		glm::mat4 projection = glm::ortho(-half_view, half_view, -half_view, half_view, 0.01f, 4.f * half_extent);
+		glm::mat4 view = glm::lookAt(glm::vec3(-1.f, 1.f, 1.f) * half_extent, glm::vec3(0.f), glm::vec3(0.f, 1.f, 0.f));
+		Frustum frustum = Frustum::FromMatrix(projection * view);
+		std::shared_ptr<std::vector<uint32_t>> visible = std::make_shared<std::vector<uint32_t>>();
+
+		//the SIMD path has to pick exactly the spheres the scalar one does
+		std::vector<uint32_t> reference;
+		FrustumCuller::CullScalar(frustum, *spheres, reference);
+		FrustumCuller::Cull(frustum, *spheres, *visible);
+		if (reference != *visible)
+			fprintf(stderr, "FrustumCull/%zu: SIMD and scalar visible sets differ (%zu vs %zu)\n", count, visible->size(), reference.size());
+
+		BenchCase bench_case;
+		bench_case.items = count;
+		bench_case.run = [spheres, frustum, visible, simd]()
+		{
+			size_t visible_count = simd ? FrustumCuller::Cull(frustum, *spheres, *visible) : FrustumCuller::CullScalar(frustum, *spheres, *visible);
+			BenchConsume(static_cast<double>(visible_count));
+		};
+		return bench_case;
+	};
+
+	suite.Add("FrustumCull", battle_counts, [make_culling_case](size_t count)
+	{
+		return make_culling_case(count, true);
+	});
+
+	suite.Add("FrustumCullScalar", battle_counts, [make_culling_case](size_t count)
+	{
+		return make_culling_case(count, false);
+	});
+}
@@ -0,0 +1,154 @@
+#include <cstdio>
+#include <memory>
+#include <random>
+#include "Bench.h"
+#include "../../Archers/Source/SpatialGrid.h"
+
+//per-tick cost of archer target acquisition through the team grids against the pairwise pass they replaced,
+//archers are kept at constant density so that the field grows with the count, the way a bigger battle would
+struct BenchArcher
+{
+	glm::vec3 pos;
+	bool red;
+};
+
+//mixed scatters both teams over the whole field. Otherwise each team keeps to a square of its own at the same
+//density, placed as far apart as the game spawns its armies, so nearest foes are across the field
+static std::vector<BenchArcher> MakeArchers(size_t count, bool mixed, std::mt19937& rng)
+{
+	//one archer per 16 square units
+	float half_extent = 2.f * glm::sqrt(static_cast<float>(count));
+	std::uniform_real_distribution<float> coord(-half_extent, half_extent);
+	std::vector<BenchArcher> archers(count);
+
+	for (size_t i = 0; i < count; i++)
+	{
+		bool red = i % 2 == 0;
+		if (mixed)
+		{
+			archers[i] = { glm::vec3(coord(rng), 2.5f, coord(rng)), red };
+		}
+		else
+		{
+			//the corners are four spreads away from each other on both axes
+			float corner = (red ? -3.f : 3.f) * half_extent;
+			archers[i] = { glm::vec3(corner + coord(rng), 2.5f, corner + coord(rng)), red };
+		}
+	}
+
+	return archers;
+}
+
+static double GridTick(const std::vector<BenchArcher>& archers, SpatialGrid& red_grid, SpatialGrid& blue_grid)
+{
+	double checksum = 0.0;
+
+	red_grid.Clear();
+	blue_grid.Clear();
+	for (size_t i = 0; i < archers.size(); i++)
+	{
+		(archers[i].red ? red_grid : blue_grid).Insert(static_cast<entt::entity>(i), archers[i].pos);
+	}
+	red_grid.Build();
+	blue_grid.Build();
+
+	for (size_t i = 0; i < archers.size(); i++)
+	{
+		bool red = archers[i].red;
+		ArcherTarget target = AcquireTarget(red ? red_grid : blue_grid, red ? blue_grid : red_grid, static_cast<entt::entity>(i), archers[i].pos, 3.4f);
+		checksum += target.distance;
+	}
+
+	return checksum;
+}
+
+//the pairwise pass the grid replaced
+static double BruteForceTick(const std::vector<BenchArcher>& archers)
+{
+	double checksum = 0.0;
+	std::vector<float> distances(archers.size(), 0.f);
+
+	for (size_t i = 0; i < archers.size(); i++)
+	{
+		for (size_t j = i + 1; j < archers.size(); j++)
+		{
+			float distance = glm::length(archers[i].pos - archers[j].pos);
+			if (archers[i].red != archers[j].red)
+			{
+				if (distances[i] == 0 || distances[i] > distance)
+					distances[i] = distance;
+				if (distances[j] == 0 || distances[j] > distance)
+					distances[j] = distance;
+			}
+			else if (distance <= 3.4f)
+			{
+				distances[i] = -1;
+				distances[j] = -1;
+			}
+		}
+	}
+
+	for (float distance : distances)
+	{
+		checksum += distance;
+	}
+
+	return checksum;
+}
+
+void RegisterGridBenches(BenchSuite& suite)
+{
+	auto grid_case = [](size_t count, bool mixed)
+	{
+		std::mt19937 rng(1234);
+		std::shared_ptr<std::vector<BenchArcher>> archers = std::make_shared<std::vector<BenchArcher>>(MakeArchers(count, mixed, rng));
+		std::shared_ptr<SpatialGrid> red_grid = std::make_shared<SpatialGrid>();
+		std::shared_ptr<SpatialGrid> blue_grid = std::make_shared<SpatialGrid>();
+
+		BenchCase bench_case;
+		bench_case.items = count;
+		bench_case.run = [archers, red_grid, blue_grid]()
+		{
+			BenchConsume(GridTick(*archers, *red_grid, *blue_grid));
+		};
+		return bench_case;
+	};
+
+	suite.Add("GridTargeting", battle_counts, [grid_case](size_t count)
+	{
+		return grid_case(count, true);
+	});
+
+	//the armies before they meet, every nearest foe is across the field
+	suite.Add("GridTargetingCorners", battle_counts, [grid_case](size_t count)
+	{
+		return grid_case(count, false);
+	});
+
+	//quadratic, larger battles would take minutes per sample
+	suite.Add("PairwiseTargeting", { 40, 400, 4000 }, [](size_t count)
+	{
+		//both passes have to find the same targets in either layout for the comparison to mean anything
+		for (bool mixed : { false, true })
+		{
+			std::mt19937 layout_rng(1234);
+			std::vector<BenchArcher> layout = MakeArchers(count, mixed, layout_rng);
+			SpatialGrid red_grid, blue_grid;
+			double grid_sum = GridTick(layout, red_grid, blue_grid);
+			double brute_sum = BruteForceTick(layout);
+			if (glm::abs(grid_sum - brute_sum) >= 1e-3 * glm::abs(brute_sum) + 1.0)
+				fprintf(stderr, "PairwiseTargeting/%zu: grid and pairwise targets differ (%f vs %f)\n", count, grid_sum, brute_sum);
+		}
+
+		std::mt19937 rng(1234);
+		std::shared_ptr<std::vector<BenchArcher>> archers = std::make_shared<std::vector<BenchArcher>>(MakeArchers(count, true, rng));
+
+		BenchCase bench_case;
+		bench_case.items = count;
+		bench_case.run = [archers]()
+		{
+			BenchConsume(BruteForceTick(*archers));
+		};
+		return bench_case;
+	});
+}
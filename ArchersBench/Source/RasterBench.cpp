@@ -0,0 +1,46 @@
+#include <memory>
+#include "Bench.h"
+#include "../../Archers/Source/BattleView.h"
+
+//whole frames of a battle drawn by the software rasterizer at the game's window size, the counts are archers
+static const std::vector<size_t> raster_counts = { 40, 400, 4000, 40000 };
+
+//a battle a few seconds in, archers spread out and arrows in the air
+static std::shared_ptr<Simulation> PlayBattle(size_t archer_count)
+{
+	std::shared_ptr<Simulation> simulation = std::make_shared<Simulation>(SimulationSettings::Scaled(static_cast<int>(archer_count), 1234));
+	for (int tick = 0; tick < 60; tick++)
+	{
+		simulation->Step();
+	}
+	return simulation;
+}
+
+void RegisterRasterBenches(BenchSuite& suite)
+{
+	auto make_case = [](size_t count, int threads)
+	{
+		std::shared_ptr<Simulation> simulation = PlayBattle(count);
+		std::shared_ptr<SoftwareRasterizer> rasterizer = std::make_shared<SoftwareRasterizer>(1280, 720, threads);
+		std::shared_ptr<BattleView> view = std::make_shared<BattleView>();
+
+		BenchCase bench_case;
+		bench_case.items = count;
+		bench_case.run = [simulation, rasterizer, view]()
+		{
+			view->Render(*simulation, *rasterizer);
+			BenchConsume(static_cast<double>(rasterizer->Row(360)[640]));
+		};
+		return bench_case;
+	};
+
+	suite.Add("RasterizeFrame", raster_counts, [make_case](size_t count)
+	{
+		return make_case(count, 0);
+	});
+
+	suite.Add("RasterizeFrameOneThread", raster_counts, [make_case](size_t count)
+	{
+		return make_case(count, 1);
+	});
+}
@@ -0,0 +1,137 @@
+#include <memory>
+#include "Bench.h"
+#include "../../Archers/Source/NullBackend.h"
+#include "../../Archers/Source/GeometryArena.h"
+#include "../../Archers/Source/StaticBatch.h"
+#include "../../Archers/Source/BattleView.h"
+
+//the CPU side of a frame up to the draw calls, drawn on the null backend, the counts are archers
+static const std::vector<size_t> render_counts = { 40, 1000, 10000, 100000 };
+
+//the game's meshes, made once since the arena they live in is shared by every case
+struct RenderAssets
+{
+	NullBackend backend;
+	LodChain* archer_lods = nullptr;
+	Mesh* arrow = nullptr;
+	Mesh* tile = nullptr;
+
+	RenderAssets()
+	{
+		GeometryArena::Create(backend);
+
+		std::vector<Vertex> tile_vertices;
+		std::vector<Vertex> arrow_vertices;
+		std::vector<uint32_t> indices;
+		Geometry::GenerateBox(glm::vec3(-5.f, -2.f, -5.f), glm::vec3(5.f, 0.f, 5.f), tile_vertices, indices);
+		Geometry::GenerateBox(glm::vec3(-0.1f, -0.1f, -1.5f), glm::vec3(0.1f, 0.1f, 1.5f), arrow_vertices, indices);
+		arrow = new Mesh(arrow_vertices, indices);
+		tile = new Mesh(tile_vertices, indices);
+		archer_lods = LodChain::GenerateSpheres(1.7f, { 32, 16, 8, 4 }, 0.5f, VertexFormat::Packed);
+	}
+
+	~RenderAssets()
+	{
+		delete archer_lods;
+		delete arrow;
+		delete tile;
+		GeometryArena::Destroy();
+	}
+};
+
+static RenderAssets& Assets()
+{
+	static RenderAssets assets;
+	return assets;
+}
+
+//a battle a few seconds in with the field merged as in the game, drawn by a renderer of its own
+struct RenderFrame
+{
+	Simulation simulation;
+	RenderSnapshot snapshot;
+	StaticBatcher field;
+	StreamBuffer stream;
+	InstancedRenderer renderer;
+	glm::mat4 projection;
+	glm::mat4 view;
+
+	RenderFrame(size_t archer_count) : simulation(SimulationSettings::Scaled(static_cast<int>(archer_count), 1234)), stream(Assets().backend),
+		renderer(Assets().backend, stream)
+	{
+		RenderAssets& assets = Assets();
+		simulation.SetMeshes(assets.archer_lods->Finest(), assets.arrow);
+		for (int tick = 0; tick < 60; tick++)
+		{
+			simulation.Step();
+		}
+		simulation.WriteSnapshot(snapshot);
+
+		entt::registry& registry = simulation.Registry();
+		for (glm::vec3 center : BattleView::FieldTiles(BattleView::field_tiles, BattleView::field_tiles, BattleView::tile_size))
+		{
+			entt::entity entity = registry.create();
+			registry.emplace<Position>(entity, center);
+			registry.emplace<Orientation>(entity, glm::quat(1.f, 0.f, 0.f, 0.f));
+			registry.emplace<MeshComponent>(entity, assets.tile, glm::vec3(0.9f), glm::vec3(0.f, 1.f, 0.f));
+			registry.emplace<StaticMesh>(entity);
+		}
+		field.Build(registry, VertexFormat::Packed);
+
+		float view_scale = simulation.Settings().field_extent / SimulationSettings().field_extent;
+		projection = BattleView::Projection(1280.f / 720.f, view_scale);
+		view = BattleView::View(BattleView::CameraPosition(0.f, view_scale));
+	}
+
+	//ArchersGame::DrawFrame with archers as meshes, program names only have to be distinct
+	void Draw()
+	{
+		stream.BeginFrame();
+		renderer.Begin();
+		renderer.SetCamera(projection, view);
+		renderer.SetProgram(1);
+		renderer.SetPackedProgram(2);
+		field.Submit(renderer);
+
+		const float alpha = 0.5f;
+		for (const SnapshotObject& object : snapshot.objects)
+		{
+			glm::vec3 pos = glm::mix(object.prev_position, object.position, alpha);
+			glm::quat ori = glm::slerp(object.prev_rotation, object.rotation, alpha);
+			renderer.Add(object.mesh, pos, ori, object.scale, object.color, object.object, object.version);
+		}
+
+		renderer.Draw();
+		stream.EndFrame();
+	}
+};
+
+void RegisterRenderBenches(BenchSuite& suite)
+{
+	auto make_case = [](size_t count, bool gpu_culling)
+	{
+		std::shared_ptr<RenderFrame> frame = std::make_shared<RenderFrame>(count);
+		//the compute dispatch is dropped, what's left is writing the instances, spheres and commands
+		frame->renderer.SetCullProgram(gpu_culling ? 3 : 0);
+		frame->renderer.SetGpuCulling(gpu_culling);
+
+		BenchCase bench_case;
+		bench_case.items = count;
+		bench_case.run = [frame]()
+		{
+			frame->Draw();
+			BenchConsume(static_cast<double>(frame->renderer.DrawCalls() + Assets().backend.Counters().triangles));
+		};
+		return bench_case;
+	};
+
+	suite.Add("RenderPrepare", render_counts, [make_case](size_t count)
+	{
+		return make_case(count, false);
+	});
+
+	suite.Add("RenderPrepareGpuCulling", render_counts, [make_case](size_t count)
+	{
+		return make_case(count, true);
+	});
+}
@@ -0,0 +1,144 @@
+#include <memory>
+#include <random>
+#include "Bench.h"
+#include "../../Archers/Source/Simulation.h"
+
+//the passes of a simulation tick one at a time, on battles built the way a headless run builds them
+
+//everyone spawned, nothing simulated yet
+static std::shared_ptr<Simulation> SpawnBattle(size_t archer_count)
+{
+	std::shared_ptr<Simulation> simulation = std::make_shared<Simulation>(SimulationSettings::Scaled(static_cast<int>(archer_count), 1234));
+	simulation->Clock().Step();
+	simulation->SpawnArchers();
+	return simulation;
+}
+
+//arrows in flight, each shot by a random archer at a point within shooting range of it
+static void SpawnArrows(Simulation& simulation, size_t arrow_count, std::mt19937& rng)
+{
+	entt::registry& registry = simulation.Registry();
+	std::vector<entt::entity> archers(registry.view<Archer>().begin(), registry.view<Archer>().end());
+	std::uniform_int_distribution<size_t> pick(0, archers.size() - 1);
+	std::uniform_real_distribution<float> angle(0.f, 2.f * glm::pi<float>());
+	std::uniform_real_distribution<float> range(5.f, 40.f);
+
+	for (size_t i = 0; i < arrow_count; i++)
+	{
+		entt::entity shooter = archers[pick(rng)];
+		glm::vec3 pos = registry.get<Position>(shooter).coord + glm::vec3(0.f, 1.7f, 0.f);
+		float a = angle(rng);
+		glm::vec3 target = registry.get<Position>(shooter).coord + range(rng) * glm::vec3(glm::cos(a), 0.f, glm::sin(a));
+		glm::quat q = glm::quatLookAt(glm::normalize(target - pos), glm::vec3(0.f, 1.f, 0.f));
+
+		entt::entity projectile = registry.create();
+		registry.emplace<Position>(projectile, pos);
+		registry.emplace<Orientation>(projectile, q);
+		registry.emplace<Trajectory>(projectile, Trajectory(pos, target, 40, 0.0, i % 2 == 0, shooter));
+		registry.emplace<PrevTransform>(projectile, pos, q);
+	}
+}
+
+void RegisterSimulationBenches(BenchSuite& suite)
+{
+	suite.Add("MoveObjects", battle_counts, [](size_t count)
+	{
+		std::shared_ptr<Simulation> simulation = SpawnBattle(count);
+		float dt = static_cast<float>(simulation->Clock().TickLength());
+
+		BenchCase bench_case;
+		bench_case.items = count;
+		bench_case.run = [simulation, dt]()
+		{
+			simulation->MoveObjects(dt);
+		};
+		return bench_case;
+	});
+
+	suite.Add("TrajectoryUpdate", battle_counts, [](size_t count)
+	{
+		std::mt19937 rng(1234);
+		std::shared_ptr<Simulation> simulation = SpawnBattle(40);
+		SpawnArrows(*simulation, count, rng);
+
+		BenchCase bench_case;
+		bench_case.items = count;
+		bench_case.run = [simulation]()
+		{
+			entt::registry& registry = simulation->Registry();
+			for (auto object : registry.view<Trajectory>())
+			{
+				registry.get<Trajectory>(object).UpdatePosition(registry.get<Position>(object), registry.get<Orientation>(object), 0.3);
+			}
+		};
+		return bench_case;
+	});
+
+	//one tick worth of sweep per arrow, a quarter of a second into the flight when most arrows are over the archers
+	suite.Add("ProjectileHitTest", battle_counts, [](size_t count)
+	{
+		std::mt19937 rng(1234);
+		std::shared_ptr<Simulation> simulation = SpawnBattle(count);
+		SpawnArrows(*simulation, count, rng);
+		simulation->BuildArcherGrids();
+
+		BenchCase bench_case;
+		bench_case.items = count;
+		bench_case.run = [simulation]()
+		{
+			entt::registry& registry = simulation->Registry();
+			size_t hits = 0;
+			for (auto object : registry.view<Trajectory>())
+			{
+				if (simulation->SweepProjectile(registry.get<Trajectory>(object), 0.25, 0.3) != entt::null)
+					hits++;
+			}
+			BenchConsume(static_cast<double>(hits));
+		};
+		return bench_case;
+	});
+
+	//grid build and the nearest ally/foe search, archers can't shoot at time zero so the battle doesn't change
+	suite.Add("ArcherTargeting", battle_counts, [](size_t count)
+	{
+		std::shared_ptr<Simulation> simulation = SpawnBattle(count);
+
+		BenchCase bench_case;
+		bench_case.items = count;
+		bench_case.run = [simulation]()
+		{
+			simulation->BuildArcherGrids();
+			simulation->UpdateArchers(0.0);
+		};
+		return bench_case;
+	});
+
+	//a tenth of the arrows land between two compactions, the way they would over a tick
+	suite.Add("RegistryCompact", battle_counts, [](size_t count)
+	{
+		std::shared_ptr<Simulation> simulation = SpawnBattle(40);
+		std::shared_ptr<std::mt19937> rng = std::make_shared<std::mt19937>(1234);
+		SpawnArrows(*simulation, count, *rng);
+
+		BenchCase bench_case;
+		bench_case.items = count;
+		bench_case.reset = [simulation, rng]()
+		{
+			entt::registry& registry = simulation->Registry();
+			std::vector<entt::entity> landed;
+			size_t i = 0;
+			for (auto object : registry.view<Trajectory>())
+			{
+				if (i++ % 10 == 0)
+					landed.push_back(object);
+			}
+			registry.destroy(landed.begin(), landed.end());
+			SpawnArrows(*simulation, landed.size(), *rng);
+		};
+		bench_case.run = [simulation]()
+		{
+			simulation->Registry().compact();
+		};
+		return bench_case;
+	});
+}